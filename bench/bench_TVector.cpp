@@ -0,0 +1,740 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdio>
+
+#include "TVector.h"
+#include "TVectorResource.h"
+#include "TVectorParallel.h"
+#include "TMappedVector.h"
+#include "TCowVector.h"
+#include "TConcurrentVector.h"
+#include "TSegmentedVector.h"
+#include "TStaticVector.h"
+#include "TVectorAllocator.h"
+
+// Heap allocations made by the process, reported by the benchmarks with
+// heap-owning payloads
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+// Same layout as int but not trivially copyable, so TVector takes the
+// element-by-element paths
+struct BoxedInt {
+    int value;
+    BoxedInt() : value(0) {}
+    BoxedInt(int v) : value(v) {}
+    BoxedInt(const BoxedInt& other) : value(other.value) {}
+    BoxedInt& operator=(const BoxedInt& other) {
+        value = other.value;
+        return *this;
+    }
+};
+
+// Indexed traversal on clean and tombstoned vectors
+template <class T> static void make_dirty(TVector<T>& vec, double ratio) {
+    size_t count = static_cast<size_t>(vec.size() * ratio);
+    if (count == 0) return;
+    size_t step = vec.size() / count;
+    for (size_t i = 0; i < count; i++) vec.erase(i * (step - 1));
+}
+
+static void BM_IndexedTraversal(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    double ratio = state.range(1) / 100.0;
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    make_dirty(vec, ratio);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (size_t i = 0; i < vec.size(); i++) sum += vec[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_IndexedTraversal)->ArgsProduct({ { 1 << 16, 1 << 20 }, { 0, 14 } });
+
+static void BM_RandomAccess(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    double ratio = state.range(1) / 100.0;
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    make_dirty(vec, ratio);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> distr(0, vec.size() - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vec[distr(gen)]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RandomAccess)->ArgsProduct({ { 1 << 16, 1 << 20 }, { 0, 14 } });
+
+// Slot state scans and compaction. Copies are compacted, so every
+// iteration tombstones a fresh copy and only the measured call is timed.
+template <class T> static void BM_Cleanup(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> proto(n);
+    for (size_t i = 0; i < n; i++) proto[i] = static_cast<T>(i);
+    for (auto _ : state) {
+        TVector<T> vec(proto);
+        make_dirty(vec, state.range(1) / 1000.0);
+        auto start = std::chrono::high_resolution_clock::now();
+        vec.reserve(0); // compacts without reallocating
+        auto finish = std::chrono::high_resolution_clock::now();
+        benchmark::DoNotOptimize(vec.data());
+        state.SetIterationTime(std::chrono::duration<double>(finish - start).count());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["state_bytes"] = static_cast<double>(TVectorStateBits::words(proto.capacity()) * sizeof(uint64_t));
+    state.counters["enum_state_bytes"] = static_cast<double>(proto.capacity() * sizeof(TVectorElemState));
+}
+BENCHMARK_TEMPLATE(BM_Cleanup, int)->Args({ 1 << 20, 125 })->Args({ 1 << 20, 10 })->UseManualTime()->Iterations(30);
+BENCHMARK_TEMPLATE(BM_Cleanup, char)->Args({ 1 << 20, 125 })->Args({ 1 << 20, 10 })->UseManualTime()->Iterations(30);
+BENCHMARK_TEMPLATE(BM_Cleanup, BoxedInt)->Args({ 1 << 20, 125 })->Args({ 1 << 20, 10 })->UseManualTime()->Iterations(30);
+
+template <class T> static void BM_PopBackDirty(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> proto(n);
+    for (auto _ : state) {
+        TVector<T> vec(proto);
+        make_dirty(vec, 0.125);
+        auto start = std::chrono::high_resolution_clock::now();
+        while (vec.size() > n / 2) vec.pop_back();
+        auto finish = std::chrono::high_resolution_clock::now();
+        benchmark::DoNotOptimize(vec.data());
+        state.SetIterationTime(std::chrono::duration<double>(finish - start).count());
+    }
+    state.SetItemsProcessed(state.iterations() * (n - n / 8 - n / 2));
+}
+BENCHMARK_TEMPLATE(BM_PopBackDirty, int)->Arg(1 << 20)->UseManualTime()->Iterations(30);
+BENCHMARK_TEMPLATE(BM_PopBackDirty, char)->Arg(1 << 20)->UseManualTime()->Iterations(30);
+
+// Appending with the fixed and geometric growth policies
+template <class Growth> static void BM_PushBack(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        TVector<int, Growth> vec;
+        for (size_t i = 0; i < n; i++) vec.push_back(static_cast<int>(i));
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, TFixedGrowth)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PushBack, TGeometricGrowth<3, 2>)->Arg(10000)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PushBack, TGeometricGrowth<>)->Arg(10000)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+// Growth with heap-owning elements: only live slots are constructed and
+// relocation moves instead of copying
+static void BM_PushBackString(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const std::string payload(64, 'x');
+    for (auto _ : state) {
+        TVector<std::string> vec;
+        for (size_t i = 0; i < n; i++) vec.push_back(payload);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_PushBackString)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Building each string where it is used: range(1) is 0 for push_back of a
+// copy, 1 for push_back of a moved string, 2 for emplace_back
+static void BM_InsertString(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t before = allocations.load();
+    for (auto _ : state) {
+        TVector<std::string> vec(TVectorCapacity{ n + 1 });
+        for (size_t i = 0; i < n; i++) {
+            if (state.range(1) == 2) {
+                vec.emplace_back(64, 'x');
+                continue;
+            }
+            std::string payload(64, 'x');
+            if (state.range(1) == 0) vec.push_back(payload);
+            else vec.push_back(std::move(payload));
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.counters["allocs_per_item"] = static_cast<double>(allocations.load() - before) / (state.iterations() * n);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_InsertString)->ArgsProduct({ { 100000 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond);
+
+// Bulk moves: memcpy/memmove for trivially copyable elements
+template <class T> static void BM_CopyDirty(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> proto(n);
+    make_dirty(proto, 0.125);
+    for (auto _ : state) {
+        TVector<T> vec(proto);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations() * proto.size() * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_CopyDirty, int)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_CopyDirty, BoxedInt)->Arg(1 << 20);
+
+template <class T> static void BM_Reserve(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        TVector<T> vec(n);
+        state.ResumeTiming();
+        vec.reserve(2 * n);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_Reserve, int)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Reserve, BoxedInt)->Arg(1 << 20);
+
+template <class T> static void BM_InsertFront(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> vec(n);
+    vec.reserve(2 * n);
+    for (auto _ : state) {
+        vec.insert(1, T(1));
+        state.PauseTiming();
+        vec.pop_back();
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_InsertFront, int)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_InsertFront, BoxedInt)->Arg(1 << 20);
+
+template <class T> static void BM_PushFront(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        TVector<T> vec;
+        for (size_t i = 0; i < n; i++) vec.push_front(T(static_cast<int>(i)));
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PushFront, int)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_PushFront, BoxedInt)->Arg(1 << 16);
+
+// Queue: every push_back is paired with a pop_front
+template <class T> static void BM_QueueRotate(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> vec(n);
+    for (auto _ : state) {
+        vec.push_back(T(1));
+        vec.pop_front();
+    }
+    benchmark::DoNotOptimize(vec.data());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_QueueRotate, int)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_QueueRotate, BoxedInt)->Arg(1 << 16);
+
+// Erase latency: eager mode pays for a full cleanup() every time DELETED_LIMIT
+// is reached, incremental mode spreads it over the following calls
+static void BM_EraseLatency(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    vec.set_compaction(state.range(1) ? TVectorCompaction::incremental : TVectorCompaction::eager);
+    std::mt19937 gen(42);
+    double worst = 0;
+    for (auto _ : state) {
+        size_t index = 1 + gen() % (vec.size() - 2);
+        auto start = std::chrono::high_resolution_clock::now();
+        vec.erase(index);
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        if (elapsed > worst) worst = elapsed;
+        state.SetIterationTime(elapsed);
+    }
+    state.counters["max_us"] = worst * 1e6;
+}
+BENCHMARK(BM_EraseLatency)->Args({ 1 << 21, 0 })->Args({ 1 << 21, 1 })->UseManualTime()->Iterations(400000);
+
+// Allocation churn: a request creates many short-lived small vectors of
+// 1..range(1) elements
+template <class Vector> static void churn(benchmark::State& state, const typename Vector::allocator_type& alloc) {
+    size_t vectors = static_cast<size_t>(state.range(0));
+    size_t longest = static_cast<size_t>(state.range(1));
+    for (size_t i = 0; i < vectors; i++) {
+        Vector vec(alloc);
+        for (size_t j = 0; j < 1 + i % longest; j++) vec.push_back(static_cast<int>(j));
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+static void BM_ChurnDefault(benchmark::State& state) {
+    for (auto _ : state) churn<TVector<int>>(state, std::allocator<int>());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnDefault)->Args({ 1000, 4 })->Args({ 1000, 24 });
+
+static void BM_ChurnArena(benchmark::State& state) {
+    TVectorArena arena;
+    for (auto _ : state) {
+        churn<pmr::TVector<int>>(state, &arena);
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnArena)->Args({ 1000, 4 })->Args({ 1000, 24 });
+
+static void BM_ChurnPool(benchmark::State& state) {
+    TVectorPool pool;
+    for (auto _ : state) churn<pmr::TVector<int>>(state, &pool);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnPool)->Args({ 1000, 4 })->Args({ 1000, 24 });
+
+static void BM_ChurnStdPool(benchmark::State& state) {
+    std::pmr::unsynchronized_pool_resource pool;
+    for (auto _ : state) churn<pmr::TVector<int>>(state, &pool);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnStdPool)->Args({ 1000, 4 })->Args({ 1000, 24 });
+
+static void BM_ChurnSmall(benchmark::State& state) {
+    for (auto _ : state) churn<TSmallVector<int, 8>>(state, std::allocator<int>());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChurnSmall)->Args({ 1000, 4 })->Args({ 1000, 24 });
+
+// Range-for over the iterators against a raw pointer loop
+static void BM_IteratorTraversal(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    make_dirty(vec, state.range(1) / 100.0);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (int value : vec) sum += value;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_IteratorTraversal)->ArgsProduct({ { 1 << 20 }, { 0, 14 } });
+
+static void BM_RawTraversal(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    for (auto _ : state) {
+        long long sum = 0;
+        const int* data = vec.data();
+        for (size_t i = 0; i < n; i++) sum += data[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RawTraversal)->Arg(1 << 20);
+
+// Search kernels: range(1) is the TVectorSimdLevel, the value is absent so
+// find_first scans the whole vector
+template <class T> static void BM_FindFirst(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<T> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<T>(i % 100);
+    make_dirty(vec, 0.05);
+    tvector_set_simd_level(static_cast<TVectorSimdLevel>(state.range(1)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find_first(vec, static_cast<T>(101)));
+    }
+    tvector_set_simd_level(TVectorSimdLevel::avx2);
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK_TEMPLATE(BM_FindFirst, int)->ArgsProduct({ { 1 << 20 }, { 0, 1, 2 } });
+BENCHMARK_TEMPLATE(BM_FindFirst, char)->ArgsProduct({ { 1 << 20 }, { 0, 1, 2 } });
+BENCHMARK_TEMPLATE(BM_FindFirst, double)->ArgsProduct({ { 1 << 20 }, { 0, 1, 2 } });
+
+static void BM_FindAll(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i % 100);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find_all(vec, 7).size());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_FindAll)->Arg(1 << 20);
+
+// Parallel algorithms: range(1) is the number of threads, from 1 to the
+// hardware concurrency
+static void parallel_threads(benchmark::internal::Benchmark* bench) {
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    for (int threads = 1; threads < hardware; threads *= 2) bench->Args({ 1 << 24, threads });
+    bench->Args({ 1 << 24, hardware < 1 ? 1 : hardware });
+    bench->UseRealTime();
+}
+
+static void BM_ParallelReduce(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVectorThreadPool pool(static_cast<size_t>(state.range(1)));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i % 100);
+    make_dirty(vec, 0.05);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(reduce(tvector_par.on(pool), vec, 0LL));
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_ParallelReduce)->Apply(parallel_threads);
+
+static void BM_ParallelFindAll(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVectorThreadPool pool(static_cast<size_t>(state.range(1)));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i % 100);
+    make_dirty(vec, 0.05);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find_all(tvector_par.on(pool), vec, 7).size());
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_ParallelFindAll)->Apply(parallel_threads);
+
+static void BM_ParallelTransform(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVectorThreadPool pool(static_cast<size_t>(state.range(1)));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i % 100);
+    make_dirty(vec, 0.05);
+    std::vector<double> output(vec.size());
+    for (auto _ : state) {
+        transform(tvector_par.on(pool), vec, output.data(), [](int x) { return x * 0.5; });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_ParallelTransform)->Apply(parallel_threads);
+
+// Batch mutations: range(2) is 0 for one call per element, 1 for the batch call
+template <class T> static void BM_InsertRange(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t k = static_cast<size_t>(state.range(1));
+    std::vector<T> values(k, T(7));
+    for (auto _ : state) {
+        state.PauseTiming();
+        TVector<T> vec(n);
+        state.ResumeTiming();
+        if (state.range(2) == 0) {
+            for (size_t i = 0; i < k; i++) vec.insert(1 + i, values[i]);
+        }
+        else {
+            vec.insert(1, values.begin(), values.end());
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * k);
+}
+BENCHMARK_TEMPLATE(BM_InsertRange, int)->ArgsProduct({ { 1 << 16 }, { 1000 }, { 0, 1 } });
+BENCHMARK_TEMPLATE(BM_InsertRange, BoxedInt)->ArgsProduct({ { 1 << 16 }, { 1000 }, { 0, 1 } });
+
+static void BM_EraseEvery(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t step = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        state.PauseTiming();
+        TVector<int> vec(n);
+        for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+        state.ResumeTiming();
+        if (state.range(2) == 0) {
+            for (size_t i = (n - 1) / step * step; i > 0; i -= step) vec.erase(i);
+        }
+        else {
+            vec.erase_if([step](int x) { return x != 0 && x % step == 0; });
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_EraseEvery)->ArgsProduct({ { 1 << 18 }, { 4 }, { 0, 1 } });
+
+// Reopening a saved vector: range(1) == 0 maps the file, 1 rebuilds the same
+// contents with push_back as a loader parsing a file would
+static void BM_MappedReopen(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std::string path = "bench_mapped_vector.bin";
+    std::remove(path.c_str());
+    {
+        TMappedVector<int> vec(path, n + 1);
+        for (size_t i = 0; i < n; i++) vec.push_back(static_cast<int>(i));
+        vec.flush();
+    }
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            TMappedVector<int> vec(path);
+            benchmark::DoNotOptimize(vec[n / 2]);
+        }
+        else {
+            TVector<int> vec;
+            for (size_t i = 0; i < n; i++) vec.push_back(static_cast<int>(i));
+            benchmark::DoNotOptimize(vec[n / 2]);
+        }
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_MappedReopen)->ArgsProduct({ { 1 << 20 }, { 0, 1 } });
+
+// range(1) == 0 saves into a buffer, 1 loads it back; range(2) percent of tombstones
+static void BM_SaveLoad(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    size_t holes = n * static_cast<size_t>(state.range(2)) / 100;
+    for (size_t i = 0; i < holes; i++) vec.erase(i * 8 % vec.size() + 1);
+    std::vector<char> buffer;
+    vec.save(buffer);
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            std::vector<char> out;
+            vec.save(out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        else {
+            TVector<int> loaded;
+            loaded.load(buffer.data(), buffer.size());
+            benchmark::DoNotOptimize(loaded.data());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_SaveLoad)->ArgsProduct({ { 1 << 20 }, { 0, 1 }, { 0, 10 } });
+
+// Handing out a snapshot: range(1) == 0 copies a TCowVector, 1 copies the TVector
+static void BM_Snapshot(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    TCowVector<int> cow(vec);
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            TCowVector<int> snapshot(cow);
+            benchmark::DoNotOptimize(&snapshot);
+        }
+        else {
+            TVector<int> snapshot(vec);
+            benchmark::DoNotOptimize(snapshot.data());
+        }
+    }
+}
+BENCHMARK(BM_Snapshot)->ArgsProduct({ { 1 << 20 }, { 0, 1 } });
+
+// Producers appending to one vector: range(0) == 0 is TConcurrentVector,
+// 1 a TVector behind a mutex. Every thread pushes a batch per iteration.
+static std::unique_ptr<TConcurrentVector<int>> ingest_concurrent;
+static std::unique_ptr<TVector<int>> ingest_locked;
+static std::mutex ingest_mutex;
+
+static void BM_ConcurrentPush(benchmark::State& state) {
+    const int batch = 1024;
+    if (state.thread_index() == 0) {
+        ingest_concurrent = std::make_unique<TConcurrentVector<int>>();
+        ingest_locked = std::make_unique<TVector<int>>();
+    }
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            for (int i = 0; i < batch; i++) ingest_concurrent->push_back(i);
+        }
+        else {
+            for (int i = 0; i < batch; i++) {
+                std::lock_guard<std::mutex> lock(ingest_mutex);
+                ingest_locked->push_back(i);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+    if (state.thread_index() == 0) {
+        ingest_concurrent.reset();
+        ingest_locked.reset();
+    }
+}
+BENCHMARK(BM_ConcurrentPush)->Arg(0)->Arg(1)->ThreadRange(1, 32)->UseRealTime();
+
+// range(1): 0 Fisher-Yates with TVectorRng, 1 with std::mt19937, 2 the
+// parallel MergeShuffle; range(2) percent of tombstones before the first run
+static void BM_Shuffle(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    size_t holes = n * static_cast<size_t>(state.range(2)) / 100;
+    for (size_t i = 0; i < holes; i++) vec.erase(i * 8 % vec.size() + 1);
+    TVectorRng rng(1);
+    std::mt19937 mt(1);
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        if (state.range(1) == 0) vectorShuffle(vec, rng);
+        else if (state.range(1) == 1) vectorShuffle(vec, mt);
+        else vectorShuffle(tvector_par.with_grain(1 << 16), vec, seed++);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * vec.size());
+}
+BENCHMARK(BM_Shuffle)->ArgsProduct({ { 1 << 20 }, { 0, 1, 2 }, { 0, 10 } });
+
+static void BM_Sample(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    size_t k = static_cast<size_t>(state.range(1));
+    TVector<int> vec(n);
+    for (size_t i = 0; i < n; i++) vec[i] = static_cast<int>(i);
+    TVectorRng rng(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vectorSample(vec, k, rng).data());
+    }
+    state.SetItemsProcessed(state.iterations() * k);
+}
+BENCHMARK(BM_Sample)->ArgsProduct({ { 1 << 20 }, { 100, 1 << 16, 1 << 19 } });
+
+// range(1): 0 radix (ascending ints), 1 comparison sort (a lambda comparator),
+// 2 stable, 3 parallel block sort and merge
+static void BM_Sort(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std::mt19937 gen(1);
+    TVector<int> source(n);
+    for (size_t i = 0; i < n; i++) source[i] = static_cast<int>(gen());
+    for (auto _ : state) {
+        state.PauseTiming();
+        TVector<int> vec(source);
+        state.ResumeTiming();
+        switch (state.range(1)) {
+        case 0: vectorSort(vec); break;
+        case 1: vectorSort(vec, [](int a, int b) { return a < b; }); break;
+        case 2: vectorStableSort(vec); break;
+        default: vectorSort(tvector_par.with_grain(1 << 16), vec); break;
+        }
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Sort)->ArgsProduct({ { 1 << 20 }, { 0, 1, 2, 3 } });
+
+// Growth from empty: range(1) == 0 is TVector, which moves every element on
+// reallocation, 1 is TSegmentedVector, which only adds chunks
+static void BM_SegmentedGrowth(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            TVector<std::string> vec;
+            for (size_t i = 0; i < n; i++) vec.emplace_back(16, 'x');
+            benchmark::DoNotOptimize(vec.data());
+        }
+        else {
+            TSegmentedVector<std::string> vec;
+            for (size_t i = 0; i < n; i++) vec.emplace_back(16, 'x');
+            benchmark::DoNotOptimize(&vec.back());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SegmentedGrowth)->ArgsProduct({ { 1 << 16, 1 << 20 }, { 0, 1 } });
+
+// Random at() on a clean vector and after erasing range(1) percent of it
+static void BM_SegmentedAt(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    TSegmentedVector<int> vec;
+    for (size_t i = 0; i < n; i++) vec.push_back(static_cast<int>(i));
+    size_t holes = n * static_cast<size_t>(state.range(1)) / 100;
+    for (size_t i = 0; i < holes; i++) vec.erase(i * 97 % vec.size());
+    std::mt19937 gen(1);
+    int64_t sum = 0;
+    for (auto _ : state) {
+        sum += vec.at(gen() % vec.size());
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SegmentedAt)->ArgsProduct({ { 1 << 20 }, { 0, 10 } });
+
+// Scratch buffer of a known bound built per call: range(0) == 0 is TVector,
+// 1 TVector with inline storage, 2 TStaticVector
+template<class Vector> static int64_t fill_scratch(Vector& vec, int seed) {
+    for (int i = 0; i < 32; i++) vec.push_back(seed + i);
+    vec.erase(3);
+    vec.insert(5, seed);
+    vec.pop_front();
+    int64_t sum = 0;
+    for (int value : vec) sum += value;
+    return sum;
+}
+
+static void BM_StaticScratch(benchmark::State& state) {
+    int seed = 0;
+    for (auto _ : state) {
+        int64_t sum = 0;
+        if (state.range(0) == 0) {
+            TVector<int> vec;
+            sum = fill_scratch(vec, seed++);
+        }
+        else if (state.range(0) == 1) {
+            TVector<int, TGeometricGrowth<>, std::allocator<int>, 32> vec;
+            sum = fill_scratch(vec, seed++);
+        }
+        else {
+            TStaticVector<int, 33> vec;
+            sum = fill_scratch(vec, seed++);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 32);
+}
+BENCHMARK(BM_StaticScratch)->DenseRange(0, 2);
+
+// range(1) == 0 is TVector<float>, 1 TAlignedVector<float> (mapped, huge
+// pages and mremap growth past HUGE_PAGE_THRESHOLD)
+static void BM_AlignedGrowth(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        if (state.range(1) == 0) {
+            TVector<float> vec;
+            for (size_t i = 0; i < n; i++) vec.push_back(static_cast<float>(i));
+            benchmark::DoNotOptimize(vec.data());
+        }
+        else {
+            TAlignedVector<float> vec;
+            for (size_t i = 0; i < n; i++) vec.push_back(static_cast<float>(i));
+            benchmark::DoNotOptimize(vec.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_AlignedGrowth)->ArgsProduct({ { 1 << 24 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+template<class Vector> static void aligned_scan(benchmark::State& state, Vector& vec) {
+    for (size_t i = 0; i < static_cast<size_t>(state.range(0)); i++) vec.push_back(static_cast<float>(i % 1000));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(find_first(vec, -1.0f));
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(float));
+}
+
+static void BM_AlignedScan(benchmark::State& state) {
+    if (state.range(1) == 0) {
+        TVector<float> vec;
+        aligned_scan(state, vec);
+    }
+    else {
+        TAlignedVector<float> vec;
+        aligned_scan(state, vec);
+    }
+}
+BENCHMARK(BM_AlignedScan)->ArgsProduct({ { 1 << 26 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
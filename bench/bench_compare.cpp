@@ -0,0 +1,201 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "TVector.h"
+
+// The same workloads on TVector and on the standard sequence containers.
+// Arguments that only make sense for TVector (tombstone ratios) are ignored
+// by the baselines. Every benchmark is registered for all three containers
+// so that the JSON output can be compared row by row.
+
+// Container operations under one name
+template <class T> static void cmp_push_front(std::vector<T>& c, const T& value) { c.insert(c.begin(), value); }
+template <class T> static void cmp_push_front(std::deque<T>& c, const T& value) { c.push_front(value); }
+template <class T> static void cmp_push_front(TVector<T>& c, const T& value) { c.push_front(value); }
+
+template <class C, class T> static void cmp_insert(C& c, size_t index, const T& value) { c.insert(c.begin() + index, value); }
+template <class T> static void cmp_insert(TVector<T>& c, size_t index, const T& value) { c.insert(index, value); }
+
+template <class C> static void cmp_erase(C& c, size_t index) { c.erase(c.begin() + index); }
+template <class T> static void cmp_erase(TVector<T>& c, size_t index) { c.erase(index); }
+
+template <class C, class T> static long long cmp_find(const C& c, const T& value) {
+    auto it = std::find(c.begin(), c.end(), value);
+    return (it == c.end()) ? -1 : static_cast<long long>(it - c.begin());
+}
+template <class T> static long long cmp_find(const TVector<T>& c, const T& value) { return find_first(c, value); }
+
+template <class C> static void cmp_shuffle(C& c, std::mt19937& gen) { std::shuffle(c.begin(), c.end(), gen); }
+template <class T> static void cmp_shuffle(TVector<T>& c, std::mt19937& gen) { vectorShuffle(c, gen); }
+
+template <class C> static void cmp_sort(C& c) { std::sort(c.begin(), c.end()); }
+template <class T> static void cmp_sort(TVector<T>& c) { vectorSort(c); }
+
+// Leaves 'percent' % tombstones in a TVector, below the cleanup threshold
+template <class C> static void cmp_tombstones(C&, long long) {}
+template <class T> static void cmp_tombstones(TVector<T>& c, long long percent) {
+    size_t count = c.size() * static_cast<size_t>(percent) / 100;
+    if (count == 0) return;
+    size_t step = c.size() / count;
+    for (size_t i = 0; i < count; i++) c.erase(i * (step - 1) + 1);
+}
+
+template <class C> static C cmp_filled(size_t n) {
+    C c;
+    for (size_t i = 0; i < n; i++) c.push_back(static_cast<int>(i));
+    return c;
+}
+
+// Registers a benchmark for the three containers with the same arguments
+#define CMP_BENCHMARK(name, ...) \
+    BENCHMARK_TEMPLATE(name, TVector<int>)__VA_ARGS__; \
+    BENCHMARK_TEMPLATE(name, std::vector<int>)__VA_ARGS__; \
+    BENCHMARK_TEMPLATE(name, std::deque<int>)__VA_ARGS__
+
+template <class C> static void BM_CmpConstruct(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        C c(n);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+CMP_BENCHMARK(BM_CmpConstruct, ->Arg(1 << 10)->Arg(1 << 20));
+
+template <class C> static void BM_CmpPushBack(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        C c;
+        for (size_t i = 0; i < n; i++) c.push_back(static_cast<int>(i));
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+CMP_BENCHMARK(BM_CmpPushBack, ->Arg(1 << 10)->Arg(1 << 20));
+
+// std::vector pays a full shift per element, hence the small size
+template <class C> static void BM_CmpPushFront(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        C c;
+        for (size_t i = 0; i < n; i++) cmp_push_front(c, static_cast<int>(i));
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+CMP_BENCHMARK(BM_CmpPushFront, ->Arg(1 << 14));
+
+// A batch of inserts at range(1) percent of the size
+template <class C> static void BM_CmpInsert(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const size_t batch = 256;
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = cmp_filled<C>(n);
+        state.ResumeTiming();
+        for (size_t i = 0; i < batch; i++) cmp_insert(c, c.size() * static_cast<size_t>(state.range(1)) / 100, -1);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+CMP_BENCHMARK(BM_CmpInsert, ->ArgsProduct({ { 1 << 16 }, { 0, 1, 50, 100 } }));
+
+// A batch of erases at range(1) percent of the size, range(2) percent of
+// tombstones already in place
+template <class C> static void BM_CmpErase(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    const size_t batch = 256;
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = cmp_filled<C>(n);
+        cmp_tombstones(c, state.range(2));
+        state.ResumeTiming();
+        for (size_t i = 0; i < batch; i++) cmp_erase(c, (c.size() - 1) * static_cast<size_t>(state.range(1)) / 100);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+CMP_BENCHMARK(BM_CmpErase, ->ArgsProduct({ { 1 << 16 }, { 0, 50, 100 }, { 0, 10 } }));
+
+template <class C> static void BM_CmpIndexed(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    C c = cmp_filled<C>(n);
+    cmp_tombstones(c, state.range(1));
+    for (auto _ : state) {
+        long long sum = 0;
+        for (size_t i = 0; i < c.size(); i++) sum += c[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * c.size());
+}
+CMP_BENCHMARK(BM_CmpIndexed, ->ArgsProduct({ { 1 << 20 }, { 0, 10 } }));
+
+// The value is absent, so the whole container is scanned
+template <class C> static void BM_CmpFind(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    C c = cmp_filled<C>(n);
+    cmp_tombstones(c, state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cmp_find(c, -1));
+    }
+    state.SetItemsProcessed(state.iterations() * c.size());
+}
+CMP_BENCHMARK(BM_CmpFind, ->ArgsProduct({ { 1 << 20 }, { 0, 10 } }));
+
+template <class C> static void BM_CmpShuffle(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    C c = cmp_filled<C>(n);
+    std::mt19937 gen(1);
+    for (auto _ : state) {
+        cmp_shuffle(c, gen);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+CMP_BENCHMARK(BM_CmpShuffle, ->Arg(1 << 16));
+
+template <class C> static void BM_CmpCopy(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    C c = cmp_filled<C>(n);
+    cmp_tombstones(c, state.range(1));
+    for (auto _ : state) {
+        C copy(c);
+        benchmark::DoNotOptimize(&copy);
+    }
+    state.SetBytesProcessed(state.iterations() * c.size() * sizeof(int));
+}
+CMP_BENCHMARK(BM_CmpCopy, ->ArgsProduct({ { 1 << 20 }, { 0, 10 } }));
+
+template <class C> static void BM_CmpMove(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    C c = cmp_filled<C>(n);
+    for (auto _ : state) {
+        C moved(std::move(c));
+        benchmark::DoNotOptimize(&moved);
+        c = std::move(moved);
+    }
+}
+CMP_BENCHMARK(BM_CmpMove, ->Arg(1 << 20));
+
+// Random keys, the container is refilled before every run
+template <class C> static void BM_CmpSort(benchmark::State& state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std::mt19937 gen(1);
+    C source = cmp_filled<C>(n);
+    for (size_t i = 0; i < n; i++) source[i] = static_cast<int>(gen());
+    cmp_tombstones(source, state.range(1));
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c(source);
+        state.ResumeTiming();
+        cmp_sort(c);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+CMP_BENCHMARK(BM_CmpSort, ->ArgsProduct({ { 1 << 20 }, { 0, 10 } }));
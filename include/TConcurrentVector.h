@@ -0,0 +1,231 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#pragma once
+#include "TVector.h"
+
+#define CONCURRENT_SHIFT 6 // the first segment holds 64 slots, one state word
+#define CONCURRENT_SEGMENTS (64 - CONCURRENT_SHIFT)
+
+// Append-only vector for many producer threads. Slot i is reserved with one
+// fetch_add, so push_back is lock-free while its segment exists; the element
+// is built in place and published by setting its busy bit, as in the state
+// bitmap of TVector. Storage is a list of segments doubling in size,
+// allocated on demand and never moved, so the reads of published elements
+// are wait-free and their references stay valid for the life of the vector.
+// Only the first producer reaching a missing segment allocates it, the others
+// yield until it is installed. The allocator must allow concurrent
+// allocate/construct calls.
+template<class T, class Allocator = std::allocator<T>> class TConcurrentVector {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    struct TSegment {
+        T* data;
+        std::atomic<uint64_t>* states; // busy bit per slot, set once the element is built
+    };
+
+    Allocator _alloc;
+    std::atomic<size_t> _size;
+    std::atomic<TSegment*> _segments[CONCURRENT_SEGMENTS];
+
+public:
+    // Constructors and destructor
+    TConcurrentVector() : TConcurrentVector(Allocator()) {}
+    explicit TConcurrentVector(const Allocator&);
+    explicit TConcurrentVector(TVectorCapacity, const Allocator& = Allocator());
+    TConcurrentVector(const TConcurrentVector&) = delete;
+    TConcurrentVector& operator=(const TConcurrentVector&) = delete;
+    ~TConcurrentVector();
+
+    // Getters. size() counts the reserved slots, some may still be under construction
+    inline size_t size() const noexcept { return _size.load(std::memory_order_acquire); };
+    inline bool is_empty() const noexcept { return size() == 0; };
+    inline Allocator get_allocator() const noexcept { return _alloc; };
+    size_t capacity() const noexcept;
+    bool is_published(size_t) const noexcept;
+    const T& at(size_t) const;
+    // Unchecked, only for elements known to be published (e.g. by push_back)
+    const T& operator[](size_t) const noexcept;
+
+    // Insertion functions, they return the index of the new element
+    size_t push_back(const T& value) { return emplace_back(value); };
+    size_t push_back(T&& value) { return emplace_back(std::move(value)); };
+    template<class... Args> size_t emplace_back(Args&&...);
+
+    // Allocates the segments of the first 'count' slots
+    void reserve(size_t);
+    // Calls function(element) for the published elements in index order
+    template<class Function> void for_each(Function) const;
+
+private:
+    static inline size_t segment_size(size_t segment) noexcept { return size_t(1) << (segment + CONCURRENT_SHIFT); };
+    // Slot 'index' lives at 'offset' of 'segment': segment k starts at 64 * (2^k - 1)
+    static inline void locate(size_t index, size_t& segment, size_t& offset) noexcept {
+        size_t shifted = index + (size_t(1) << CONCURRENT_SHIFT);
+        size_t high = 63 - tvector_clz(shifted);
+        segment = high - CONCURRENT_SHIFT;
+        offset = shifted - (size_t(1) << high);
+    };
+    // Marks a segment that one producer is allocating
+    static inline TSegment* installing() noexcept {
+        static TSegment marker{ nullptr, nullptr };
+        return &marker;
+    };
+    // The segment or nullptr while it is missing or being installed
+    inline TSegment* installed(size_t k) const noexcept {
+        TSegment* segment = _segments[k].load(std::memory_order_acquire);
+        return (segment == installing()) ? nullptr : segment;
+    };
+    TSegment* segment(size_t);
+    TSegment* create(size_t);
+    void destroy(TSegment*, size_t) noexcept;
+};
+
+template<class T, class Allocator> TConcurrentVector<T, Allocator>::TConcurrentVector(const Allocator& alloc) :
+    _alloc(alloc),
+    _size(0)
+{
+    for (std::atomic<TSegment*>& segment : _segments) segment.store(nullptr, std::memory_order_relaxed);
+}
+
+template<class T, class Allocator> TConcurrentVector<T, Allocator>::TConcurrentVector(TVectorCapacity capacity, const Allocator& alloc) :
+    TConcurrentVector(alloc)
+{
+    reserve(capacity.value);
+}
+
+// No producer may run at this point
+template<class T, class Allocator> TConcurrentVector<T, Allocator>::~TConcurrentVector() {
+    for (size_t k = 0; k < CONCURRENT_SEGMENTS; k++) {
+        TSegment* segment = installed(k);
+        if (segment != nullptr) destroy(segment, k);
+    }
+}
+
+template<class T, class Allocator> size_t TConcurrentVector<T, Allocator>::capacity() const noexcept {
+    size_t result = 0;
+    for (size_t k = 0; k < CONCURRENT_SEGMENTS; k++) {
+        if (installed(k) != nullptr) result += segment_size(k);
+    }
+    return result;
+}
+
+template<class T, class Allocator> bool TConcurrentVector<T, Allocator>::is_published(size_t index) const noexcept {
+    size_t k = 0;
+    size_t offset = 0;
+    locate(index, k, offset);
+    TSegment* segment = installed(k);
+    if (segment == nullptr) return false;
+    return (segment->states[offset / 64].load(std::memory_order_acquire) >> (offset % 64)) & 1;
+}
+
+template<class T, class Allocator> const T& TConcurrentVector<T, Allocator>::at(size_t index) const {
+    if (!is_published(index)) {
+        throw std::out_of_range("TConcurrentVector.at: 'index' out of range or not published yet");
+    }
+    return (*this)[index];
+}
+
+template<class T, class Allocator> const T& TConcurrentVector<T, Allocator>::operator[](size_t index) const noexcept {
+    size_t k = 0;
+    size_t offset = 0;
+    locate(index, k, offset);
+    return _segments[k].load(std::memory_order_acquire)->data[offset];
+}
+
+// A slot whose constructor throws is never published, readers skip it
+template<class T, class Allocator> template<class... Args> size_t TConcurrentVector<T, Allocator>::emplace_back(Args&&... args) {
+    size_t index = _size.fetch_add(1, std::memory_order_relaxed);
+    size_t k = 0;
+    size_t offset = 0;
+    locate(index, k, offset);
+    TSegment* target = segment(k);
+    alloc_traits::construct(_alloc, target->data + offset, std::forward<Args>(args)...);
+    target->states[offset / 64].fetch_or(uint64_t(1) << (offset % 64), std::memory_order_release);
+    return index;
+}
+
+template<class T, class Allocator> void TConcurrentVector<T, Allocator>::reserve(size_t count) {
+    if (count == 0) return;
+    size_t last = 0;
+    size_t offset = 0;
+    locate(count - 1, last, offset);
+    for (size_t k = 0; k <= last; k++) segment(k);
+}
+
+template<class T, class Allocator> template<class Function> void TConcurrentVector<T, Allocator>::for_each(Function function) const {
+    size_t end = size();
+    for (size_t k = 0, first = 0; first < end; first += segment_size(k), k++) {
+        TSegment* segment = installed(k);
+        if (segment == nullptr) continue;
+        size_t slots = std::min(segment_size(k), end - first);
+        for (size_t group = 0; group * 64 < slots; group++) {
+            uint64_t word = segment->states[group].load(std::memory_order_acquire);
+            if (slots - group * 64 < 64) word &= (uint64_t(1) << (slots - group * 64)) - 1;
+            while (word != 0) {
+                function(static_cast<const T&>(segment->data[group * 64 + tvector_ctz(word)]));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+// The thread that swaps the marker in allocates the segment, the others wait
+// for it instead of allocating a segment of their own. If the allocation
+// throws, the slot is cleared and the next caller tries again.
+template<class T, class Allocator> typename TConcurrentVector<T, Allocator>::TSegment* TConcurrentVector<T, Allocator>::segment(size_t k) {
+    TSegment* current = _segments[k].load(std::memory_order_acquire);
+    while (current == nullptr || current == installing()) {
+        if (current == installing()) {
+            std::this_thread::yield();
+            current = _segments[k].load(std::memory_order_acquire);
+            continue;
+        }
+        if (!_segments[k].compare_exchange_weak(current, installing(), std::memory_order_acquire, std::memory_order_acquire)) continue;
+        try {
+            current = create(k);
+        }
+        catch (...) {
+            _segments[k].store(nullptr, std::memory_order_release);
+            throw;
+        }
+        _segments[k].store(current, std::memory_order_release);
+    }
+    return current;
+}
+
+template<class T, class Allocator> typename TConcurrentVector<T, Allocator>::TSegment* TConcurrentVector<T, Allocator>::create(size_t k) {
+    size_t slots = segment_size(k);
+    TSegment* segment = new TSegment{ nullptr, nullptr };
+    try {
+        segment->data = alloc_traits::allocate(_alloc, slots);
+        segment->states = new std::atomic<uint64_t>[slots / 64]();
+    }
+    catch (...) {
+        if (segment->data != nullptr) alloc_traits::deallocate(_alloc, segment->data, slots);
+        delete segment;
+        throw;
+    }
+    return segment;
+}
+
+template<class T, class Allocator> void TConcurrentVector<T, Allocator>::destroy(TSegment* segment, size_t k) noexcept {
+    size_t slots = segment_size(k);
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (size_t group = 0; group < slots / 64; group++) {
+            uint64_t word = segment->states[group].load(std::memory_order_acquire);
+            while (word != 0) {
+                alloc_traits::destroy(_alloc, segment->data + group * 64 + tvector_ctz(word));
+                word &= word - 1;
+            }
+        }
+    }
+    alloc_traits::deallocate(_alloc, segment->data, slots);
+    delete[] segment->states;
+    delete segment;
+}
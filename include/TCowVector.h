@@ -0,0 +1,185 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#pragma once
+#include "TVector.h"
+
+// Copy-on-write handle to a TVector. Copies share one vector through an
+// intrusive atomic reference count, so a snapshot costs a pointer bump; the first
+// mutation through a shared handle copies the live elements. Shared vectors
+// are always clean, their reads touch no cached state and are safe from
+// several threads at once: copying a dirty vector makes a compact deep copy
+// and leaves the source alone (compact() makes it shareable again). A vector
+// that has handed out a mutable reference is never shared either, writes
+// through the reference must not reach the snapshots.
+template<class T, class Growth = TGeometricGrowth<>, class Allocator = std::allocator<T>, size_t Inline = 0> class TCowVector {
+public:
+    using vector_type = TVector<T, Growth, Allocator, Inline>;
+    using const_iterator = typename vector_type::const_iterator;
+
+private:
+    // The vector and its reference count in one allocation
+    struct TBlock {
+        std::atomic<size_t> references;
+        // Set once a mutable reference into the vector is handed out, only by its sole owner
+        bool unshareable;
+        vector_type vector;
+
+        template<class... Args> explicit TBlock(Args&&... args) : references(1), unshareable(false), vector(std::forward<Args>(args)...) {}
+    };
+
+    TBlock* _block;
+
+public:
+    // Constructors and destructor
+    TCowVector() : _block(retain(empty_block())) {}
+    explicit TCowVector(const Allocator& alloc) : _block(new TBlock(alloc)) {}
+    explicit TCowVector(std::initializer_list<T> data) : _block(new TBlock(data)) {}
+    explicit TCowVector(const vector_type& vec) : _block(new TBlock(vec)) {}
+    explicit TCowVector(vector_type&& vec) : _block(new TBlock(std::move(vec))) {}
+    TCowVector(const TCowVector& other) : _block(share(other._block)) {}
+    // The moved-from handle is left empty
+    TCowVector(TCowVector&& other) noexcept : _block(std::exchange(other._block, retain(empty_block()))) {}
+    ~TCowVector() { release(_block); }
+
+    TCowVector& operator=(const TCowVector&);
+    TCowVector& operator=(TCowVector&&) noexcept;
+
+    // Getters
+    inline size_t size() const noexcept { return view().size(); };
+    inline size_t capacity() const noexcept { return view().capacity(); };
+    inline bool is_empty() const noexcept { return view().is_empty(); };
+    inline bool is_shared() const noexcept { return use_count() > 1; };
+    inline size_t use_count() const noexcept { return _block->references.load(std::memory_order_acquire); };
+    // Read-only access to the shared vector, e.g. for find_first() or save()
+    inline const vector_type& view() const noexcept { return _block->vector; };
+    // Write access to the vector, detached from the other handles. Later
+    // copies of this handle are deep copies.
+    inline vector_type& edit() { return expose(); };
+
+    inline const_iterator begin() const noexcept { return view().begin(); };
+    inline const_iterator end() const noexcept { return view().end(); };
+    inline const_iterator cbegin() const noexcept { return begin(); };
+    inline const_iterator cend() const noexcept { return end(); };
+
+    // Reading functions never detach
+    inline const T& at(size_t index) const { return view().at(index); };
+    inline const T& operator[](size_t index) const { return view()[index]; };
+    inline const T& front() const { return view().front(); };
+    inline const T& back() const { return view().back(); };
+
+    // Writing functions detach first. The ones returning a reference make
+    // later copies of this handle deep copies.
+    inline T& at(size_t index) { return expose().at(index); };
+    inline T& operator[](size_t index) { return expose()[index]; };
+    inline T& front() { return expose().front(); };
+    inline T& back() { return expose().back(); };
+    inline void emplace(size_t index, const T& value) { detach().emplace(index, value); };
+    inline void emplace(size_t index, T&& value) { detach().emplace(index, std::move(value)); };
+
+    inline void push_front(const T& value) { detach().push_front(value); };
+    inline void push_front(T&& value) { detach().push_front(std::move(value)); };
+    inline void push_back(const T& value) { detach().push_back(value); };
+    inline void push_back(T&& value) { detach().push_back(std::move(value)); };
+    inline void insert(size_t index, const T& value) { detach().insert(index, value); };
+    inline void insert(size_t index, T&& value) { detach().insert(index, std::move(value)); };
+    template<class... Args> inline T& emplace_front(Args&&... args) { return expose().emplace_front(std::forward<Args>(args)...); };
+    template<class... Args> inline T& emplace_back(Args&&... args) { return expose().emplace_back(std::forward<Args>(args)...); };
+    template<class... Args> inline T& emplace_at(size_t index, Args&&... args) { return expose().emplace_at(index, std::forward<Args>(args)...); };
+    template<class Iterator, class = typename std::iterator_traits<Iterator>::iterator_category> inline void insert(size_t index, Iterator first, Iterator last) {
+        detach().insert(index, first, last);
+    };
+    template<class Iterator, class = typename std::iterator_traits<Iterator>::iterator_category> inline void append(Iterator first, Iterator last) {
+        detach().append(first, last);
+    };
+
+    inline void pop_front() { detach().pop_front(); };
+    inline void pop_back() { detach().pop_back(); };
+    inline void erase(size_t index) { detach().erase(index); };
+    inline void erase(const std::vector<size_t>& indexes) { detach().erase(indexes); };
+    template<class Predicate> inline size_t erase_if(Predicate predicate) { return detach().erase_if(predicate); };
+
+    void clear();
+    inline void reserve(size_t new_capacity) { detach().reserve(new_capacity); };
+    inline void resize(size_t new_size) { detach().resize(new_size); };
+    inline void shrink_to_fit() { detach().shrink_to_fit(); };
+    // Drops the tombstones, so that the next copy shares the vector again
+    inline void compact() { detach().compact(); };
+
+    // Operators overload
+    inline bool operator==(const TCowVector& other) const { return _block == other._block || view() == other.view(); };
+    inline bool operator!=(const TCowVector& other) const { return !(*this == other); };
+
+private:
+    vector_type& detach();
+    inline vector_type& expose() {
+        vector_type& vector = detach();
+        _block->unshareable = true;
+        return vector;
+    };
+    static TBlock* share(TBlock*);
+    static TBlock* empty_block();
+    static inline TBlock* retain(TBlock* block) noexcept {
+        block->references.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    };
+    static inline void release(TBlock* block) noexcept {
+        if (block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) delete block;
+    };
+};
+
+template<class T, class Growth, class Allocator, size_t Inline> TCowVector<T, Growth, Allocator, Inline>& TCowVector<T, Growth, Allocator, Inline>::operator=(const TCowVector& other) {
+    TBlock* block = share(other._block);
+    release(_block);
+    _block = block;
+    return *this;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> TCowVector<T, Growth, Allocator, Inline>& TCowVector<T, Growth, Allocator, Inline>::operator=(TCowVector&& other) noexcept {
+    std::swap(_block, other._block);
+    return *this;
+}
+
+// A shared vector is left with its elements to the other handles
+template<class T, class Growth, class Allocator, size_t Inline> void TCowVector<T, Growth, Allocator, Inline>::clear() {
+    if (is_shared()) {
+        TBlock* block = new TBlock(view().get_allocator());
+        release(_block);
+        _block = block;
+    }
+    else {
+        _block->vector.clear();
+    }
+}
+
+// The copy is compact, the copy constructor of TVector drops the tombstones.
+// The acquire load of a count of one makes the reads of handles released in
+// other threads happen before the writes that follow.
+template<class T, class Growth, class Allocator, size_t Inline> typename TCowVector<T, Growth, Allocator, Inline>::vector_type& TCowVector<T, Growth, Allocator, Inline>::detach() {
+    if (is_shared()) {
+        TBlock* block = new TBlock(view());
+        release(_block);
+        _block = block;
+    }
+    return _block->vector;
+}
+
+// Block for a copy of a handle. The source is only read: copying one const
+// handle from several threads at once is safe. A dirty or unshareable
+// vector is copied, the copy constructor of TVector drops the tombstones.
+template<class T, class Growth, class Allocator, size_t Inline> typename TCowVector<T, Growth, Allocator, Inline>::TBlock* TCowVector<T, Growth, Allocator, Inline>::share(TBlock* block) {
+    if (block->unshareable || !block->vector._is_clean) return new TBlock(block->vector);
+    return retain(block);
+}
+
+// Shared by the default constructed and moved-from handles. It keeps its own
+// reference, so it is never written and never freed.
+template<class T, class Growth, class Allocator, size_t Inline> typename TCowVector<T, Growth, Allocator, Inline>::TBlock* TCowVector<T, Growth, Allocator, Inline>::empty_block() {
+    static TBlock* block = new TBlock();
+    return block;
+}
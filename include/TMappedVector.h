@@ -0,0 +1,369 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#pragma once
+#include "TVector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAPPED_MAGIC 0x3150414D43455654ull // "TVECMAP1"
+#define MAPPED_VERSION 1
+
+// File layout of TMappedVector: this header, then the element slots, then the
+// state bitmap on the next cache line. The header is 64 bytes, so the slots start cache-line aligned.
+struct TMappedVectorHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t capacity;
+    uint64_t size; // slots of the live region, tombstones included
+    uint64_t deleted;
+    uint64_t clean;
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(TMappedVectorHeader) == 64, "TMappedVectorHeader: the slots must start at offset 64");
+
+// Vector of trivially copyable elements kept in a memory-mapped file. Slots
+// and states use the layout of TVector (the live region always starts at
+// slot 0), so opening an existing file only maps it and checks the header;
+// the rank index is rebuilt if the file was saved with tombstones.
+// Every change goes straight to the mapping, flush() makes it durable.
+template<class T, class Growth = TGeometricGrowth<>> class TMappedVector {
+    static_assert(std::is_trivially_copyable<T>::value, "TMappedVector: elements must be trivially copyable");
+    static_assert(alignof(T) <= sizeof(TMappedVectorHeader), "TMappedVector: element alignment is too large");
+
+    int _fd;
+    char* _map;
+    size_t _mapped;
+    TMappedVectorHeader* _header;
+    T* _data;
+    uint64_t* _states;
+    TVectorRankIndex _rank;
+
+public:
+    // Opens the file or creates it with the given capacity
+    explicit TMappedVector(const std::string&, size_t = CAPACITY);
+    TMappedVector(const TMappedVector&) = delete;
+    TMappedVector(TMappedVector&&) noexcept;
+    TMappedVector& operator=(const TMappedVector&) = delete;
+    TMappedVector& operator=(TMappedVector&&) noexcept;
+    ~TMappedVector();
+
+    // Getters
+    inline size_t size() const noexcept { return _header->size - _header->deleted; };
+    inline size_t capacity() const noexcept { return _header->capacity; };
+    inline bool is_empty() const noexcept { return size() == 0; };
+    inline bool is_clean() const noexcept { return _header->clean != 0; };
+    // Slots in order, only contiguous while the vector is clean
+    inline T* data() const noexcept { return _data; };
+    inline T& front() const { return at(0); };
+    inline T& back() const { return at(size() - 1); };
+
+    T& at(size_t) const;
+    T& operator[](size_t) const;
+    void emplace(size_t, const T&);
+
+    // Insertion and deletion functions
+    void push_back(const T&);
+    void pop_back();
+    void erase(size_t);
+    void clear() noexcept;
+
+    // Memory management functions
+    void reserve(size_t);
+    void cleanup();
+    // Writes the mapping back to the file, 'wait' blocks until it is on disk
+    void flush(bool = true);
+
+private:
+    // The state bitmap starts at the next cache line after the slots
+    static inline size_t states_offset(size_t capacity) noexcept {
+        return (sizeof(TMappedVectorHeader) + capacity * sizeof(T) + 63) & ~size_t(63);
+    };
+    static inline size_t file_size(size_t capacity) noexcept {
+        return states_offset(capacity) + TVectorStateBits::words(capacity) * sizeof(uint64_t);
+    };
+    void map(size_t);
+    void remap(size_t);
+    void bind() noexcept;
+    void unmap() noexcept;
+    void grow(size_t);
+    size_t translate_index(size_t) const;
+    inline void mark_clean() noexcept {
+        _header->clean = 1;
+        _rank.reset();
+    };
+    [[noreturn]] static void fail(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    };
+};
+
+template<class T, class Growth> TMappedVector<T, Growth>::TMappedVector(const std::string& path, size_t initial_capacity) :
+    _fd(-1),
+    _map(nullptr),
+    _mapped(0),
+    _header(nullptr),
+    _data(nullptr),
+    _states(nullptr)
+{
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) fail("TMappedVector: cannot open the file");
+    try {
+        struct stat info;
+        if (::fstat(_fd, &info) != 0) fail("TMappedVector: cannot stat the file");
+        if (info.st_size == 0) {
+            if (initial_capacity == 0) initial_capacity = 1;
+            if (::ftruncate(_fd, static_cast<off_t>(file_size(initial_capacity))) != 0) fail("TMappedVector: cannot size the file");
+            map(file_size(initial_capacity));
+            std::memset(_map, 0, _mapped);
+            _header->magic = MAPPED_MAGIC;
+            _header->version = MAPPED_VERSION;
+            _header->element_size = sizeof(T);
+            _header->capacity = initial_capacity;
+            _header->clean = 1;
+            bind();
+            return;
+        }
+        if (static_cast<size_t>(info.st_size) < sizeof(TMappedVectorHeader)) {
+            throw std::runtime_error("TMappedVector: the file is not a mapped vector");
+        }
+        map(static_cast<size_t>(info.st_size));
+        if (_header->magic != MAPPED_MAGIC || _header->version != MAPPED_VERSION || _header->element_size != sizeof(T) ||
+            file_size(_header->capacity) != _mapped || _header->size > _header->capacity || _header->deleted > _header->size) {
+            throw std::runtime_error("TMappedVector: the file is not a mapped vector of this element type");
+        }
+        bind();
+        if (!is_clean()) _rank.build(_states, capacity());
+    }
+    catch (...) {
+        unmap();
+        ::close(_fd);
+        throw;
+    }
+}
+
+template<class T, class Growth> TMappedVector<T, Growth>::TMappedVector(TMappedVector&& other) noexcept :
+    _fd(std::exchange(other._fd, -1)),
+    _map(std::exchange(other._map, nullptr)),
+    _mapped(std::exchange(other._mapped, 0)),
+    _header(std::exchange(other._header, nullptr)),
+    _data(std::exchange(other._data, nullptr)),
+    _states(std::exchange(other._states, nullptr)),
+    _rank(std::move(other._rank))
+{}
+
+template<class T, class Growth> TMappedVector<T, Growth>& TMappedVector<T, Growth>::operator=(TMappedVector&& other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    if (_fd >= 0) ::close(_fd);
+    _fd = std::exchange(other._fd, -1);
+    _map = std::exchange(other._map, nullptr);
+    _mapped = std::exchange(other._mapped, 0);
+    _header = std::exchange(other._header, nullptr);
+    _data = std::exchange(other._data, nullptr);
+    _states = std::exchange(other._states, nullptr);
+    _rank = std::move(other._rank);
+    return *this;
+}
+
+// Unmapping does not sync: the kernel writes the pages back on its own, call flush() for durability
+template<class T, class Growth> TMappedVector<T, Growth>::~TMappedVector() {
+    unmap();
+    if (_fd >= 0) ::close(_fd);
+}
+
+template<class T, class Growth> T& TMappedVector<T, Growth>::at(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("TMappedVector.at: 'index' out of range or vector is empty");
+    }
+    return _data[translate_index(index)];
+}
+
+template<class T, class Growth> T& TMappedVector<T, Growth>::operator[](size_t index) const {
+    return _data[translate_index(index)];
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::emplace(size_t index, const T& value) {
+    at(index) = value;
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::push_back(const T& value) {
+    // A copy first: growing remaps the file and 'value' may live in it
+    T copy = value;
+    if (_header->size + 1 >= _header->capacity) grow(size() + 1);
+    size_t slot = _header->size;
+    _data[slot] = copy;
+    TVectorStateBits::set(_states, slot, TVectorElemState::busy);
+    _header->size++;
+    if (!is_clean()) _rank.update(slot, true);
+}
+
+// The last slot of the live region is always busy, tombstones right before it are dropped as well
+template<class T, class Growth> void TMappedVector<T, Growth>::pop_back() {
+    if (is_empty()) {
+        throw std::logic_error("TMappedVector.pop_back: Impossible to delete - there are no elements in the vector");
+    }
+    size_t slot = _header->size - 1;
+    size_t end = (slot == 0) ? 0 : TVectorStateBits::prev_busy(_states, slot - 1) + 1;
+    TVectorStateBits::fill(_states, end, slot + 1, TVectorElemState::empty);
+    _header->deleted -= slot - end;
+    _header->size = end;
+    if (is_clean()) return;
+    if (_header->deleted == 0) {
+        mark_clean();
+        return;
+    }
+    _rank.update(slot, false);
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::erase(size_t index) {
+    if (is_empty()) {
+        throw std::logic_error("TMappedVector.erase: Impossible to delete - there are no elements in the vector");
+    }
+    if (index == size() - 1) {
+        pop_back();
+        return;
+    }
+    size_t slot = translate_index(index);
+    TVectorStateBits::set(_states, slot, TVectorElemState::deleted);
+    _header->deleted++;
+    if (is_clean()) {
+        _header->clean = 0;
+        _rank.build(_states, capacity());
+    }
+    else {
+        _rank.update(slot, false);
+    }
+    if (_header->deleted >= static_cast<size_t>(_header->size * DELETED_LIMIT)) cleanup();
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::clear() noexcept {
+    TVectorStateBits::fill(_states, 0, _header->size, TVectorElemState::empty);
+    _header->size = 0;
+    _header->deleted = 0;
+    mark_clean();
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::reserve(size_t new_capacity) {
+    cleanup();
+    if (new_capacity > capacity()) remap(new_capacity);
+}
+
+// Moves the busy runs down over the tombstones
+template<class T, class Growth> void TMappedVector<T, Growth>::cleanup() {
+    if (_header->deleted == 0) return;
+    size_t end = _header->size;
+    size_t index = 0;
+    for (size_t first = TVectorStateBits::next_busy(_states, 0, end); first < end; ) {
+        size_t last = TVectorStateBits::next_not_busy(_states, first, end);
+        if (first != index) std::memmove(_data + index, _data + first, (last - first) * sizeof(T));
+        index += last - first;
+        first = TVectorStateBits::next_busy(_states, last, end);
+    }
+    TVectorStateBits::fill(_states, 0, index, TVectorElemState::busy);
+    TVectorStateBits::fill(_states, index, end, TVectorElemState::empty);
+    _header->size = index;
+    _header->deleted = 0;
+    mark_clean();
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::flush(bool wait) {
+    if (_map == nullptr) return;
+    if (::msync(_map, _mapped, wait ? MS_SYNC : MS_ASYNC) != 0) fail("TMappedVector.flush: msync failed");
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::map(size_t bytes) {
+    void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (address == MAP_FAILED) fail("TMappedVector: cannot map the file");
+    _map = static_cast<char*>(address);
+    _mapped = bytes;
+    _header = reinterpret_cast<TMappedVectorHeader*>(_map);
+}
+
+// Extends the file and the mapping, then moves the state bitmap behind the new slots
+template<class T, class Growth> void TMappedVector<T, Growth>::remap(size_t new_capacity) {
+    size_t old_capacity = capacity();
+    size_t bytes = file_size(new_capacity);
+    if (::ftruncate(_fd, static_cast<off_t>(bytes)) != 0) fail("TMappedVector: cannot grow the file");
+#if defined(__linux__)
+    void* address = ::mremap(_map, _mapped, bytes, MREMAP_MAYMOVE);
+    if (address == MAP_FAILED) fail("TMappedVector: cannot remap the file");
+    _map = static_cast<char*>(address);
+    _mapped = bytes;
+    _header = reinterpret_cast<TMappedVectorHeader*>(_map);
+#else
+    unmap();
+    map(bytes);
+#endif
+    size_t old_words = TVectorStateBits::words(old_capacity);
+    uint64_t* old_states = reinterpret_cast<uint64_t*>(_map + states_offset(old_capacity));
+    uint64_t* new_states = reinterpret_cast<uint64_t*>(_map + states_offset(new_capacity));
+    std::memmove(new_states, old_states, old_words * sizeof(uint64_t));
+    std::memset(new_states + old_words, 0, (TVectorStateBits::words(new_capacity) - old_words) * sizeof(uint64_t));
+    _header->capacity = new_capacity;
+    bind();
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::bind() noexcept {
+    _data = reinterpret_cast<T*>(_map + sizeof(TMappedVectorHeader));
+    _states = reinterpret_cast<uint64_t*>(_map + states_offset(capacity()));
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::unmap() noexcept {
+    if (_map != nullptr) ::munmap(_map, _mapped);
+    _map = nullptr;
+    _mapped = 0;
+    _header = nullptr;
+    _data = nullptr;
+    _states = nullptr;
+}
+
+template<class T, class Growth> void TMappedVector<T, Growth>::grow(size_t required) {
+    cleanup();
+    size_t new_capacity = Growth::next_capacity(capacity(), required, CAPACITY);
+    if (new_capacity > capacity()) remap(new_capacity);
+}
+
+template<class T, class Growth> size_t TMappedVector<T, Growth>::translate_index(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("TMappedVector: logical index out of range");
+    }
+    if (is_clean()) return index;
+    size_t cursor = _rank.cursor_rank();
+    if (cursor != TVectorRankIndex::npos) {
+        size_t slot = _rank.cursor_slot();
+        if (index == cursor) return slot;
+        if (index == cursor + 1) {
+            slot = TVectorStateBits::next_busy(_states, slot + 1, _header->size);
+            _rank.move_cursor(index, slot);
+            return slot;
+        }
+    }
+    size_t rank = 0;
+    size_t block = _rank.select(index, rank);
+    for (size_t group = block * (RANK_BLOCK / 64); group * 64 < _header->size; group++) {
+        uint64_t word = TVectorStateBits::busy_word(_states, group);
+        size_t count = tvector_popcount(word);
+        if (rank < count) {
+            size_t slot = group * 64 + TVectorStateBits::select(word, rank);
+            _rank.move_cursor(index, slot);
+            return slot;
+        }
+        rank -= count;
+    }
+    throw std::logic_error("TMappedVector: internal consistency error");
+}
+
+#endif
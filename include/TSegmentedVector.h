@@ -0,0 +1,562 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#pragma once
+#include "TVector.h"
+
+#define SEGMENT_SLOTS 1024 // slots per chunk of TSegmentedVector
+
+// Vector stored in fixed-size chunks listed in a table. Growth allocates one
+// chunk and never moves elements, so their addresses stay valid while the
+// vector grows. Every chunk keeps its own state bitmap in the layout of
+// TVector: erase leaves a tombstone, and a chunk is compacted on its own once
+// its tombstones pass DELETED_LIMIT. While every chunk but the last is full
+// and no tombstone is left the vector is clean and at() is O(1); otherwise a
+// Fenwick tree over the live counts of the chunks finds the chunk.
+// Only insert, chunk compaction and shrink_to_fit move elements, the first
+// two inside one chunk.
+template<class T, class Allocator = std::allocator<T>, size_t Chunk = SEGMENT_SLOTS> class TSegmentedVector {
+    static_assert(Chunk >= 64 && Chunk % 64 == 0, "TSegmentedVector: the chunk size must be a multiple of 64");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    struct TChunk {
+        T* data;
+        uint64_t states[TVectorStateBits::words(Chunk)];
+        size_t used; // slots [0, used) hold elements or tombstones, the last one is busy
+        size_t live;
+    };
+
+    Allocator _alloc;
+    std::vector<TChunk*> _chunks; // chunks in use, then the spare ones
+    size_t _count; // chunks in use
+    std::vector<size_t> _tree; // Fenwick tree of the live counts, only while dirty
+    size_t _size;
+    bool _is_clean;
+
+public:
+    template<bool Const> class basic_iterator {
+        friend class TSegmentedVector;
+        template<bool> friend class basic_iterator;
+        using owner_type = typename std::conditional<Const, const TSegmentedVector, TSegmentedVector>::type;
+
+        owner_type* _owner;
+        size_t _chunk;
+        size_t _slot;
+
+        basic_iterator(owner_type* owner, size_t chunk, size_t slot) noexcept : _owner(owner), _chunk(chunk), _slot(slot) { settle(); }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<Const, const T*, T*>::type;
+        using reference = typename std::conditional<Const, const T&, T&>::type;
+
+        basic_iterator() noexcept : _owner(nullptr), _chunk(0), _slot(0) {}
+        template<bool Other, class = typename std::enable_if<Const && !Other>::type>
+        basic_iterator(const basic_iterator<Other>& other) noexcept : _owner(other._owner), _chunk(other._chunk), _slot(other._slot) {}
+
+        inline reference operator*() const noexcept { return _owner->_chunks[_chunk]->data[_slot]; };
+        inline pointer operator->() const noexcept { return &**this; };
+        inline basic_iterator& operator++() noexcept {
+            _slot++;
+            settle();
+            return *this;
+        };
+        inline basic_iterator operator++(int) noexcept {
+            basic_iterator result = *this;
+            ++*this;
+            return result;
+        };
+        inline bool operator==(const basic_iterator& other) const noexcept { return _chunk == other._chunk && _slot == other._slot; };
+        inline bool operator!=(const basic_iterator& other) const noexcept { return !(*this == other); };
+
+    private:
+        // Moves to the next busy slot, the end is (chunk count, 0)
+        void settle() noexcept {
+            while (_chunk < _owner->_count) {
+                const TChunk* chunk = _owner->_chunks[_chunk];
+                if (_slot < chunk->used) {
+                    if (chunk->live == chunk->used) return;
+                    _slot = TVectorStateBits::next_busy(chunk->states, _slot, chunk->used);
+                    if (_slot < chunk->used) return;
+                }
+                _chunk++;
+                _slot = 0;
+            }
+        };
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    // Constructors and destructor
+    TSegmentedVector() : TSegmentedVector(Allocator()) {}
+    explicit TSegmentedVector(const Allocator& alloc) : _alloc(alloc), _count(0), _size(0), _is_clean(true) {}
+    explicit TSegmentedVector(std::initializer_list<T>, const Allocator& = Allocator());
+    TSegmentedVector(const TSegmentedVector&);
+    TSegmentedVector(TSegmentedVector&&) noexcept;
+    ~TSegmentedVector();
+
+    TSegmentedVector& operator=(const TSegmentedVector&);
+    TSegmentedVector& operator=(TSegmentedVector&&) noexcept;
+
+    // Getters
+    inline size_t size() const noexcept { return _size; };
+    inline size_t capacity() const noexcept { return _chunks.size() * Chunk; };
+    inline size_t chunk_count() const noexcept { return _count; };
+    inline bool is_empty() const noexcept { return _size == 0; };
+    inline bool is_clean() const noexcept { return _is_clean; };
+    inline Allocator get_allocator() const noexcept { return _alloc; };
+    inline T& front() const { return at(0); };
+    inline T& back() const { return at(_size - 1); };
+
+    inline iterator begin() noexcept { return iterator(this, 0, 0); };
+    inline iterator end() noexcept { return iterator(this, _count, 0); };
+    inline const_iterator begin() const noexcept { return const_iterator(this, 0, 0); };
+    inline const_iterator end() const noexcept { return const_iterator(this, _count, 0); };
+
+    T& at(size_t) const;
+    T& operator[](size_t) const;
+    void emplace(size_t, const T&);
+
+    // Insertion functions
+    void push_back(const T& value) { emplace_back(value); };
+    void push_back(T&& value) { emplace_back(std::move(value)); };
+    template<class... Args> T& emplace_back(Args&&...);
+    void push_front(const T& value) { insert(0, value); };
+    void insert(size_t, const T&);
+
+    // Deletion functions
+    void pop_back();
+    void pop_front() { erase(0); };
+    void erase(size_t);
+    void clear() noexcept;
+
+    // Memory management functions
+    // Allocates the chunks of 'count' elements, later growth only fills them
+    void reserve(size_t);
+    // Packs the elements into full chunks and frees the spare ones. The only
+    // call moving elements between chunks, it makes the vector clean.
+    void shrink_to_fit();
+    // Calls function(element) in order, chunks without tombstones are walked directly
+    template<class Function> void for_each(Function) const;
+
+private:
+    void locate(size_t, size_t&, size_t&) const noexcept;
+    void allocate_chunk();
+    void add_chunk(size_t);
+    void drop_chunk(size_t) noexcept;
+    void compact_chunk(TChunk*);
+    void split_chunk(size_t);
+    void trim_chunk(size_t) noexcept;
+    void mark_dirty();
+    void destroy_all() noexcept;
+
+    // Fenwick tree over the live counts of the chunks in use
+    void tree_build();
+    void tree_add(size_t, std::ptrdiff_t) noexcept;
+    size_t tree_select(size_t, size_t&) const noexcept;
+};
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>::TSegmentedVector(std::initializer_list<T> data, const Allocator& alloc) :
+    TSegmentedVector(alloc)
+{
+    reserve(data.size());
+    for (const T& value : data) push_back(value);
+}
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>::TSegmentedVector(const TSegmentedVector& other) :
+    TSegmentedVector(alloc_traits::select_on_container_copy_construction(other._alloc))
+{
+    reserve(other._size);
+    other.for_each([this](const T& value) { push_back(value); });
+}
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>::TSegmentedVector(TSegmentedVector&& other) noexcept :
+    _alloc(std::move(other._alloc)),
+    _chunks(std::move(other._chunks)),
+    _count(std::exchange(other._count, 0)),
+    _tree(std::move(other._tree)),
+    _size(std::exchange(other._size, 0)),
+    _is_clean(std::exchange(other._is_clean, true))
+{
+    other._chunks.clear();
+    other._tree.clear();
+}
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>::~TSegmentedVector() {
+    destroy_all();
+}
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>& TSegmentedVector<T, Allocator, Chunk>::operator=(const TSegmentedVector& other) {
+    if (this == &other) return *this;
+    TSegmentedVector copy(other);
+    return *this = std::move(copy);
+}
+
+template<class T, class Allocator, size_t Chunk> TSegmentedVector<T, Allocator, Chunk>& TSegmentedVector<T, Allocator, Chunk>::operator=(TSegmentedVector&& other) noexcept {
+    if (this == &other) return *this;
+    destroy_all();
+    _alloc = std::move(other._alloc);
+    _chunks = std::move(other._chunks);
+    _count = std::exchange(other._count, 0);
+    _tree = std::move(other._tree);
+    _size = std::exchange(other._size, 0);
+    _is_clean = std::exchange(other._is_clean, true);
+    other._chunks.clear();
+    other._tree.clear();
+    return *this;
+}
+
+template<class T, class Allocator, size_t Chunk> T& TSegmentedVector<T, Allocator, Chunk>::at(size_t index) const {
+    if (index >= _size) {
+        throw std::out_of_range("TSegmentedVector.at: 'index' out of range or vector is empty");
+    }
+    return (*this)[index];
+}
+
+template<class T, class Allocator, size_t Chunk> T& TSegmentedVector<T, Allocator, Chunk>::operator[](size_t index) const {
+    if (_is_clean) return _chunks[index / Chunk]->data[index % Chunk];
+    size_t chunk = 0;
+    size_t slot = 0;
+    locate(index, chunk, slot);
+    return _chunks[chunk]->data[slot];
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::emplace(size_t index, const T& value) {
+    at(index) = value;
+}
+
+template<class T, class Allocator, size_t Chunk> template<class... Args> T& TSegmentedVector<T, Allocator, Chunk>::emplace_back(Args&&... args) {
+    bool fresh = _count == 0 || _chunks[_count - 1]->used == Chunk;
+    if (fresh) add_chunk(_count);
+    TChunk* last = _chunks[_count - 1];
+    T* slot = last->data + last->used;
+    try {
+        alloc_traits::construct(_alloc, slot, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        if (fresh) drop_chunk(_count - 1);
+        throw;
+    }
+    TVectorStateBits::set(last->states, last->used, TVectorElemState::busy);
+    last->used++;
+    last->live++;
+    _size++;
+    if (!_is_clean) tree_add(_count - 1, 1);
+    return *slot;
+}
+
+// The chunk of 'index' is compacted first, a full chunk is split in two
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::insert(size_t index, const T& value) {
+    if (index > _size) {
+        throw std::out_of_range("TSegmentedVector.insert: 'index' out of range");
+    }
+    if (index == _size) {
+        push_back(value);
+        return;
+    }
+    T copy(value);
+    mark_dirty();
+    size_t chunk = 0;
+    size_t slot = 0;
+    locate(index, chunk, slot);
+    if (_chunks[chunk]->live != _chunks[chunk]->used) {
+        compact_chunk(_chunks[chunk]);
+        locate(index, chunk, slot);
+    }
+    if (_chunks[chunk]->used == Chunk) {
+        split_chunk(chunk);
+        locate(index, chunk, slot);
+    }
+    TChunk* target = _chunks[chunk];
+    T* data = target->data;
+    size_t used = target->used;
+    alloc_traits::construct(_alloc, data + used, std::move_if_noexcept(data[used - 1]));
+    // Slots (next, used] hold the shifted elements
+    size_t next = used - 1;
+    try {
+        for (; next > slot; next--) data[next] = std::move(data[next - 1]);
+        data[slot] = std::move(copy);
+    }
+    catch (...) {
+        // The shifted elements go back and the extra one is destroyed. Should
+        // moving back throw as well, the slots keep valid but shifted values.
+        try {
+            for (size_t i = next + 1; i < used; i++) data[i] = std::move(data[i + 1]);
+        }
+        catch (...) {
+        }
+        alloc_traits::destroy(_alloc, data + used);
+        throw;
+    }
+    TVectorStateBits::set(target->states, used, TVectorElemState::busy);
+    target->used++;
+    target->live++;
+    _size++;
+    tree_add(chunk, 1);
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::pop_back() {
+    if (is_empty()) {
+        throw std::logic_error("TSegmentedVector.pop_back: Impossible to delete - there are no elements in the vector");
+    }
+    size_t chunk = _count - 1;
+    TChunk* last = _chunks[chunk];
+    alloc_traits::destroy(_alloc, last->data + last->used - 1);
+    TVectorStateBits::set(last->states, last->used - 1, TVectorElemState::empty);
+    last->used--;
+    last->live--;
+    _size--;
+    if (!_is_clean) tree_add(chunk, -1);
+    trim_chunk(chunk);
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::erase(size_t index) {
+    if (index >= _size) {
+        throw std::out_of_range("TSegmentedVector.erase: 'index' out of range or vector is empty");
+    }
+    if (index == _size - 1) {
+        pop_back();
+        return;
+    }
+    mark_dirty();
+    size_t chunk = 0;
+    size_t slot = 0;
+    locate(index, chunk, slot);
+    TChunk* target = _chunks[chunk];
+    alloc_traits::destroy(_alloc, target->data + slot);
+    TVectorStateBits::set(target->states, slot, TVectorElemState::deleted);
+    target->live--;
+    _size--;
+    tree_add(chunk, -1);
+    if (slot == target->used - 1 || target->live == 0) {
+        trim_chunk(chunk);
+    }
+    else if (target->used - target->live >= static_cast<size_t>(target->used * DELETED_LIMIT)) {
+        compact_chunk(target);
+    }
+}
+
+// The chunks are kept for the next growth
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::clear() noexcept {
+    for (size_t i = 0; i < _count; i++) {
+        TChunk* chunk = _chunks[i];
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (size_t slot = TVectorStateBits::next_busy(chunk->states, 0, chunk->used); slot < chunk->used; slot = TVectorStateBits::next_busy(chunk->states, slot + 1, chunk->used)) {
+                alloc_traits::destroy(_alloc, chunk->data + slot);
+            }
+        }
+        TVectorStateBits::fill(chunk->states, 0, chunk->used, TVectorElemState::empty);
+        chunk->used = 0;
+        chunk->live = 0;
+    }
+    _count = 0;
+    _tree.clear();
+    _size = 0;
+    _is_clean = true;
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::reserve(size_t count) {
+    size_t free = (_chunks.size() - _count) * Chunk + (_count == 0 ? 0 : Chunk - _chunks[_count - 1]->used);
+    if (count <= _size + free) return;
+    size_t needed = (count - _size - free + Chunk - 1) / Chunk;
+    _chunks.reserve(_chunks.size() + needed);
+    for (size_t i = 0; i < needed; i++) allocate_chunk();
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::shrink_to_fit() {
+    if (!_is_clean) {
+        TSegmentedVector packed(_alloc);
+        packed.reserve(_size);
+        for_each([&packed](T& value) { packed.push_back(std::move_if_noexcept(value)); });
+        *this = std::move(packed);
+    }
+    for (size_t i = _count; i < _chunks.size(); i++) {
+        alloc_traits::deallocate(_alloc, _chunks[i]->data, Chunk);
+        delete _chunks[i];
+    }
+    _chunks.resize(_count);
+    _chunks.shrink_to_fit();
+}
+
+template<class T, class Allocator, size_t Chunk> template<class Function> void TSegmentedVector<T, Allocator, Chunk>::for_each(Function function) const {
+    for (size_t i = 0; i < _count; i++) {
+        const TChunk* chunk = _chunks[i];
+        if (chunk->live == chunk->used) {
+            for (size_t slot = 0; slot < chunk->used; slot++) function(chunk->data[slot]);
+            continue;
+        }
+        for (size_t group = 0; group * 64 < chunk->used; group++) {
+            uint64_t word = TVectorStateBits::busy_word(chunk->states, group);
+            while (word != 0) {
+                function(chunk->data[group * 64 + tvector_ctz(word)]);
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+// Chunk and slot of a logical index on a dirty vector
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::locate(size_t index, size_t& chunk, size_t& slot) const noexcept {
+    size_t rank = 0;
+    chunk = tree_select(index, rank);
+    const TChunk* target = _chunks[chunk];
+    if (target->live == target->used) {
+        slot = rank;
+        return;
+    }
+    for (size_t group = 0; ; group++) {
+        uint64_t word = TVectorStateBits::busy_word(target->states, group);
+        size_t count = tvector_popcount(word);
+        if (rank < count) {
+            slot = group * 64 + TVectorStateBits::select(word, rank);
+            return;
+        }
+        rank -= count;
+    }
+}
+
+// Appends a new spare chunk to the table
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::allocate_chunk() {
+    std::unique_ptr<TChunk> chunk(new TChunk());
+    chunk->data = alloc_traits::allocate(_alloc, Chunk);
+    try {
+        _chunks.push_back(chunk.get());
+    }
+    catch (...) {
+        alloc_traits::deallocate(_alloc, chunk->data, Chunk);
+        throw;
+    }
+    chunk.release();
+}
+
+// Puts an empty chunk at 'position' of the table, a spare one if there is any
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::add_chunk(size_t position) {
+    if (_count == _chunks.size()) allocate_chunk();
+    std::rotate(_chunks.begin() + position, _chunks.begin() + _count, _chunks.begin() + _count + 1);
+    _count++;
+    if (!_is_clean) tree_build();
+}
+
+// Turns an empty chunk into a spare one. The tree only shrinks, so it is
+// rebuilt without allocation.
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::drop_chunk(size_t position) noexcept {
+    std::rotate(_chunks.begin() + position, _chunks.begin() + position + 1, _chunks.begin() + _count);
+    _count--;
+    if (_size == 0) {
+        _tree.clear();
+        _is_clean = true;
+    }
+    else if (!_is_clean) {
+        tree_build();
+    }
+}
+
+// Moves the busy slots of one chunk down over its tombstones. The states
+// follow every relocation, so a throwing copy leaves a valid dirty chunk.
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::compact_chunk(TChunk* chunk) {
+    size_t index = 0;
+    for (size_t slot = TVectorStateBits::next_busy(chunk->states, 0, chunk->used); slot < chunk->used; slot = TVectorStateBits::next_busy(chunk->states, slot + 1, chunk->used)) {
+        if (slot != index) {
+            alloc_traits::construct(_alloc, chunk->data + index, std::move_if_noexcept(chunk->data[slot]));
+            alloc_traits::destroy(_alloc, chunk->data + slot);
+            TVectorStateBits::set(chunk->states, index, TVectorElemState::busy);
+            TVectorStateBits::set(chunk->states, slot, TVectorElemState::deleted);
+        }
+        index++;
+    }
+    TVectorStateBits::fill(chunk->states, index, chunk->used, TVectorElemState::empty);
+    chunk->used = index;
+}
+
+// Moves the upper half of a full, compact chunk to a new chunk after it. The
+// sources are destroyed and the states set only once every element is built,
+// a throwing copy leaves the vector as it was.
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::split_chunk(size_t index) {
+    add_chunk(index + 1);
+    TChunk* source = _chunks[index];
+    TChunk* half = _chunks[index + 1];
+    const size_t middle = Chunk / 2;
+    size_t built = 0;
+    try {
+        for (; built < Chunk - middle; built++) {
+            alloc_traits::construct(_alloc, half->data + built, std::move_if_noexcept(source->data[middle + built]));
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < built; i++) alloc_traits::destroy(_alloc, half->data + i);
+        drop_chunk(index + 1);
+        throw;
+    }
+    for (size_t slot = middle; slot < Chunk; slot++) alloc_traits::destroy(_alloc, source->data + slot);
+    TVectorStateBits::fill(half->states, 0, Chunk - middle, TVectorElemState::busy);
+    TVectorStateBits::fill(source->states, middle, Chunk, TVectorElemState::empty);
+    half->used = half->live = Chunk - middle;
+    source->used = source->live = middle;
+    tree_build();
+}
+
+// Drops the tombstones at the end of a chunk and the chunk itself once it is empty
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::trim_chunk(size_t index) noexcept {
+    TChunk* chunk = _chunks[index];
+    size_t end = (chunk->live == 0) ? 0 : TVectorStateBits::prev_busy(chunk->states, chunk->used - 1) + 1;
+    TVectorStateBits::fill(chunk->states, end, chunk->used, TVectorElemState::empty);
+    chunk->used = end;
+    if (chunk->live == 0) drop_chunk(index);
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::mark_dirty() {
+    if (!_is_clean) return;
+    tree_build();
+    _is_clean = false;
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::destroy_all() noexcept {
+    clear();
+    for (TChunk* chunk : _chunks) {
+        alloc_traits::deallocate(_alloc, chunk->data, Chunk);
+        delete chunk;
+    }
+    _chunks.clear();
+}
+
+// Linear build: every node passes its sum to its parent
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::tree_build() {
+    _tree.assign(_count + 1, 0);
+    for (size_t i = 1; i <= _count; i++) {
+        _tree[i] += _chunks[i - 1]->live;
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= _count) _tree[parent] += _tree[i];
+    }
+}
+
+template<class T, class Allocator, size_t Chunk> void TSegmentedVector<T, Allocator, Chunk>::tree_add(size_t chunk, std::ptrdiff_t delta) noexcept {
+    for (size_t i = chunk + 1; i < _tree.size(); i += i & (~i + 1)) _tree[i] += static_cast<size_t>(delta);
+}
+
+// Chunk holding the element of the given rank, its rank inside the chunk goes to 'remainder'
+template<class T, class Allocator, size_t Chunk> size_t TSegmentedVector<T, Allocator, Chunk>::tree_select(size_t rank, size_t& remainder) const noexcept {
+    size_t count = _tree.size() - 1;
+    size_t step = 1;
+    while (step * 2 <= count) step *= 2;
+    size_t position = 0;
+    for (; step != 0; step /= 2) {
+        if (position + step <= count && _tree[position + step] <= rank) {
+            position += step;
+            rank -= _tree[position];
+        }
+    }
+    remainder = rank;
+    return position;
+}
@@ -0,0 +1,329 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#pragma once
+
+// Functions of TStaticVector are constant expressions from C++20 on, where
+// constexpr allows uninitialized storage, std::construct_at and destructors
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201907L && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define TVECTOR_CONSTEXPR constexpr
+#else
+#define TVECTOR_CONSTEXPR
+#endif
+
+// Narrowest unsigned type holding 0..N, it keeps small vectors small
+template<size_t N> using TStaticSize = typename std::conditional<(N <= UINT8_MAX), uint8_t,
+    typename std::conditional<(N <= UINT16_MAX), uint16_t,
+    typename std::conditional<(N <= UINT32_MAX), uint32_t, size_t>::type>::type>::type;
+
+template<class T, class... Args> TVECTOR_CONSTEXPR inline T* tvector_construct_at(T* slot, Args&&... args) {
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+    return std::construct_at(slot, std::forward<Args>(args)...);
+#else
+    return ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Storage of TStaticVector. Trivial types get a plain array and a trivial
+// destructor, so the vector is a literal type; others live in a union and
+// are destroyed by hand.
+template<class T, size_t N, bool Trivial = std::is_trivial<T>::value> class TStaticStorage {
+protected:
+    T _data[N];
+    TStaticSize<N> _size;
+
+    TVECTOR_CONSTEXPR TStaticStorage() noexcept : _size(0) {}
+};
+
+template<class T, size_t N> class TStaticStorage<T, N, false> {
+protected:
+    union {
+        T _data[N];
+    };
+    TStaticSize<N> _size;
+
+    TVECTOR_CONSTEXPR TStaticStorage() noexcept : _size(0) {}
+    TVECTOR_CONSTEXPR ~TStaticStorage() {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (size_t i = 0; i < _size; i++) _data[i].~T();
+        }
+    }
+};
+
+// Vector of at most N elements stored inside the object, for scratch
+// buffers with a known bound. There is no heap, no growth and no state
+// bitmap: erase compacts at once, so the elements are always contiguous and
+// index i is data()[i]. Insertion into a full vector throws length_error.
+template<class T, size_t N> class TStaticVector : private TStaticStorage<T, N> {
+    static_assert(N > 0, "TStaticVector: the capacity must be positive");
+
+    using TStaticStorage<T, N>::_data;
+    using TStaticStorage<T, N>::_size;
+
+public:
+    using value_type = T;
+    using size_type = TStaticSize<N>;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Constructors
+    TVECTOR_CONSTEXPR TStaticVector() noexcept {}
+    TVECTOR_CONSTEXPR explicit TStaticVector(size_t);
+    TVECTOR_CONSTEXPR explicit TStaticVector(std::initializer_list<T>);
+    TVECTOR_CONSTEXPR TStaticVector(const TStaticVector&);
+    TVECTOR_CONSTEXPR TStaticVector(TStaticVector&&) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+    // Getters
+    TVECTOR_CONSTEXPR inline T* data() noexcept { return _data; };
+    TVECTOR_CONSTEXPR inline const T* data() const noexcept { return _data; };
+    TVECTOR_CONSTEXPR inline size_t size() const noexcept { return _size; };
+    static constexpr size_t capacity() noexcept { return N; };
+    TVECTOR_CONSTEXPR inline T& front() { return at(0); };
+    TVECTOR_CONSTEXPR inline const T& front() const { return at(0); };
+    TVECTOR_CONSTEXPR inline T& back() { return at(size() - 1); };
+    TVECTOR_CONSTEXPR inline const T& back() const { return at(size() - 1); };
+
+    TVECTOR_CONSTEXPR inline iterator begin() noexcept { return _data; };
+    TVECTOR_CONSTEXPR inline iterator end() noexcept { return _data + _size; };
+    TVECTOR_CONSTEXPR inline const_iterator begin() const noexcept { return _data; };
+    TVECTOR_CONSTEXPR inline const_iterator end() const noexcept { return _data + _size; };
+    TVECTOR_CONSTEXPR inline const_iterator cbegin() const noexcept { return begin(); };
+    TVECTOR_CONSTEXPR inline const_iterator cend() const noexcept { return end(); };
+
+    // Functions
+    TVECTOR_CONSTEXPR inline bool is_empty() const noexcept { return _size == 0; };
+    TVECTOR_CONSTEXPR inline bool is_full() const noexcept { return _size == N; };
+    TVECTOR_CONSTEXPR T& at(size_t);
+    TVECTOR_CONSTEXPR const T& at(size_t) const;
+    TVECTOR_CONSTEXPR void emplace(size_t, const T&);
+    TVECTOR_CONSTEXPR void emplace(size_t, T&&);
+
+    // Insertion functions
+    TVECTOR_CONSTEXPR void push_front(const T& value) { emplace_at(0, value); };
+    TVECTOR_CONSTEXPR void push_front(T&& value) { emplace_at(0, std::move(value)); };
+    TVECTOR_CONSTEXPR void push_back(const T& value) { emplace_back(value); };
+    TVECTOR_CONSTEXPR void push_back(T&& value) { emplace_back(std::move(value)); };
+    TVECTOR_CONSTEXPR void insert(size_t index, const T& value) { emplace_at(index, value); };
+    TVECTOR_CONSTEXPR void insert(size_t index, T&& value) { emplace_at(index, std::move(value)); };
+    template<class... Args> TVECTOR_CONSTEXPR T& emplace_front(Args&&... args) { return emplace_at(0, std::forward<Args>(args)...); };
+    template<class... Args> TVECTOR_CONSTEXPR T& emplace_back(Args&&...);
+    template<class... Args> TVECTOR_CONSTEXPR T& emplace_at(size_t, Args&&...);
+
+    // Deletion functions
+    TVECTOR_CONSTEXPR void pop_front() { erase(0); };
+    TVECTOR_CONSTEXPR void pop_back();
+    TVECTOR_CONSTEXPR void erase(size_t);
+    template<class Predicate> TVECTOR_CONSTEXPR size_t erase_if(Predicate);
+    TVECTOR_CONSTEXPR void clear() noexcept;
+    TVECTOR_CONSTEXPR void resize(size_t);
+
+    // Operators overload
+    TVECTOR_CONSTEXPR TStaticVector& operator=(const TStaticVector&);
+    TVECTOR_CONSTEXPR TStaticVector& operator=(TStaticVector&&) noexcept(std::is_nothrow_move_assignable<T>::value && std::is_nothrow_move_constructible<T>::value);
+    TVECTOR_CONSTEXPR bool operator==(const TStaticVector&) const;
+    TVECTOR_CONSTEXPR bool operator!=(const TStaticVector& other) const { return !(*this == other); };
+    TVECTOR_CONSTEXPR inline T& operator[](size_t index) noexcept { return _data[index]; };
+    TVECTOR_CONSTEXPR inline const T& operator[](size_t index) const noexcept { return _data[index]; };
+
+private:
+    TVECTOR_CONSTEXPR void destroy_from(size_t) noexcept;
+};
+
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>::TStaticVector(size_t size) {
+    if (size > N) {
+        throw std::length_error("TStaticVector.size_constructor: Invalid argument 'size' - must not exceed the capacity");
+    }
+    // The count is raised per element, so a throwing constructor leaves only built elements to destroy
+    for (size_t i = 0; i < size; i++, _size++) tvector_construct_at(_data + i);
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>::TStaticVector(std::initializer_list<T> init) {
+    if (init.size() > N) {
+        throw std::length_error("TStaticVector.initlist_constructor: Invalid argument 'init' - must not exceed the capacity");
+    }
+    for (const T& value : init) {
+        tvector_construct_at(_data + _size, value);
+        _size++;
+    }
+}
+
+// Only the live elements are copied, the rest of the storage is never read
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>::TStaticVector(const TStaticVector& other) {
+    for (size_t i = 0; i < other._size; i++, _size++) tvector_construct_at(_data + i, other._data[i]);
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>::TStaticVector(TStaticVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    for (size_t i = 0; i < other._size; i++, _size++) tvector_construct_at(_data + i, std::move(other._data[i]));
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR T& TStaticVector<T, N>::at(size_t index) {
+    if (index >= _size) {
+        throw std::out_of_range("TStaticVector.at: 'index' out of range or vector is empty");
+    }
+    return _data[index];
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR const T& TStaticVector<T, N>::at(size_t index) const {
+    if (index >= _size) {
+        throw std::out_of_range("TStaticVector.at: 'index' out of range or vector is empty");
+    }
+    return _data[index];
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::emplace(size_t index, const T& value) {
+    if (index >= _size) {
+        throw std::out_of_range("TStaticVector.emplace: 'index' out of range or vector is empty");
+    }
+    _data[index] = value;
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::emplace(size_t index, T&& value) {
+    if (index >= _size) {
+        throw std::out_of_range("TStaticVector.emplace: 'index' out of range or vector is empty");
+    }
+    _data[index] = std::move(value);
+}
+
+template<class T, size_t N> template<class... Args> TVECTOR_CONSTEXPR T& TStaticVector<T, N>::emplace_back(Args&&... args) {
+    if (is_full()) {
+        throw std::length_error("TStaticVector.emplace_back: Impossible to insert - the vector is full");
+    }
+    T* slot = tvector_construct_at(_data + _size, std::forward<Args>(args)...);
+    _size++;
+    return *slot;
+}
+
+// The tail moves up by one slot; for trivial types std::move_backward is a memmove
+template<class T, size_t N> template<class... Args> TVECTOR_CONSTEXPR T& TStaticVector<T, N>::emplace_at(size_t index, Args&&... args) {
+    if (index > _size) {
+        throw std::out_of_range("TStaticVector.emplace_at: 'index' out of range");
+    }
+    if (is_full()) {
+        throw std::length_error("TStaticVector.emplace_at: Impossible to insert - the vector is full");
+    }
+    if (index == _size) return emplace_back(std::forward<Args>(args)...);
+    T value(std::forward<Args>(args)...);
+    tvector_construct_at(_data + _size, std::move(_data[_size - 1]));
+    _size++;
+    std::move_backward(_data + index, _data + _size - 2, _data + _size - 1);
+    _data[index] = std::move(value);
+    return _data[index];
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::pop_back() {
+    if (is_empty()) {
+        throw std::logic_error("TStaticVector.pop_back: Impossible to delete - there are no elements in the vector");
+    }
+    destroy_from(_size - 1);
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::erase(size_t index) {
+    if (is_empty()) {
+        throw std::logic_error("TStaticVector.erase: Impossible to delete - there are no elements in the vector");
+    }
+    if (index >= _size) {
+        throw std::out_of_range("TStaticVector.erase: 'index' out of range");
+    }
+    std::move(_data + index + 1, _data + _size, _data + index);
+    destroy_from(_size - 1);
+}
+
+// One pass moving the kept elements down, returns the number of erased ones
+template<class T, size_t N> template<class Predicate> TVECTOR_CONSTEXPR size_t TStaticVector<T, N>::erase_if(Predicate predicate) {
+    size_t kept = 0;
+    for (size_t i = 0; i < _size; i++) {
+        if (predicate(static_cast<const T&>(_data[i]))) continue;
+        if (kept != i) _data[kept] = std::move(_data[i]);
+        kept++;
+    }
+    size_t erased = _size - kept;
+    destroy_from(kept);
+    return erased;
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::clear() noexcept {
+    destroy_from(0);
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::resize(size_t new_size) {
+    if (new_size > N) {
+        throw std::length_error("TStaticVector.resize: Invalid argument 'new_size' - must not exceed the capacity");
+    }
+    if (new_size < _size) destroy_from(new_size);
+    while (_size < new_size) {
+        tvector_construct_at(_data + _size);
+        _size++;
+    }
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>& TStaticVector<T, N>::operator=(const TStaticVector& other) {
+    if (this == &other) return *this;
+    size_t common = std::min<size_t>(_size, other._size);
+    std::copy(other._data, other._data + common, _data);
+    destroy_from(common);
+    for (size_t i = common; i < other._size; i++, _size++) tvector_construct_at(_data + i, other._data[i]);
+    return *this;
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR TStaticVector<T, N>& TStaticVector<T, N>::operator=(TStaticVector&& other) noexcept(std::is_nothrow_move_assignable<T>::value && std::is_nothrow_move_constructible<T>::value) {
+    if (this == &other) return *this;
+    size_t common = std::min<size_t>(_size, other._size);
+    std::move(other._data, other._data + common, _data);
+    destroy_from(common);
+    for (size_t i = common; i < other._size; i++, _size++) tvector_construct_at(_data + i, std::move(other._data[i]));
+    return *this;
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR bool TStaticVector<T, N>::operator==(const TStaticVector& other) const {
+    return std::equal(begin(), end(), other.begin(), other.end());
+}
+
+// Destroys the elements from 'index' on and shrinks the vector to it
+template<class T, size_t N> TVECTOR_CONSTEXPR void TStaticVector<T, N>::destroy_from(size_t index) noexcept {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (size_t i = index; i < _size; i++) _data[i].~T();
+    }
+    _size = static_cast<size_type>(index);
+}
+
+// Search functions, the same contract as for TVector
+
+template<class T, size_t N> TVECTOR_CONSTEXPR int find_first(const TStaticVector<T, N>& vector, const T& value) {
+    if (vector.is_empty()) {
+        throw std::logic_error("find_first: Impossible to find an element - vector is empty");
+    }
+    for (size_t i = 0; i < vector.size(); i++) {
+        if (vector[i] == value) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+template<class T, size_t N> TVECTOR_CONSTEXPR int find_last(const TStaticVector<T, N>& vector, const T& value) {
+    if (vector.is_empty()) {
+        throw std::logic_error("find_last: Impossible to find an element - vector is empty");
+    }
+    for (size_t i = vector.size(); i > 0; i--) {
+        if (vector[i - 1] == value) return static_cast<int>(i - 1);
+    }
+    return -1;
+}
+
+// Returns the indices of all matches in increasing order, empty if there are none
+template<class T, size_t N> std::vector<int> find_all(const TStaticVector<T, N>& vector, const T& value) {
+    if (vector.is_empty()) {
+        throw std::logic_error("find_all: Impossible to find elements - vector is empty");
+    }
+    std::vector<int> result;
+    for (size_t i = 0; i < vector.size(); i++) {
+        if (vector[i] == value) result.push_back(static_cast<int>(i));
+    }
+    return result;
+}
@@ -4,128 +4,829 @@
 #include <random>
 #include <chrono>
 #include <initializer_list>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <functional>
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <stdexcept>
+#include <memory_resource>
+#include <algorithm>
+#include <unordered_set>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 #pragma once
+#include "TVectorSimd.h"
+#include "TVectorStats.h"
+#include "TVectorSerialize.h"
+#include "TVectorRandom.h"
+#include "TVectorSort.h"
 #define CAPACITY 15
 #define DELETED_LIMIT 0.15
+#define RANK_BLOCK 512 // eight busy words of the state bitmap
+#define COMPACTION_STEP 256 // slots compacted per mutating call in incremental mode
 
 enum class TVectorElemState { empty, busy, deleted };
 
-template<class T> class TVector {
+// eager: cleanup() compacts the whole vector once DELETED_LIMIT is reached
+// incremental: compaction is spread over the following mutating calls
+enum class TVectorCompaction { eager, incremental };
+
+// Growth policies: return the capacity to grow to when at least 'required'
+// slots are needed. 'initial' is the initial capacity of the vector.
+template<size_t Numerator = 2, size_t Denominator = 1> struct TGeometricGrowth {
+    static_assert(Numerator > Denominator, "TGeometricGrowth: growth factor must be > 1");
+
+    static inline size_t next_capacity(size_t capacity, size_t required, size_t initial) noexcept {
+        size_t result = capacity / Denominator * Numerator + capacity % Denominator * Numerator / Denominator;
+        if (result < required) result = required;
+        if (result < initial) result = initial;
+        return result;
+    };
+};
+
+struct TFixedGrowth {
+    static inline size_t next_capacity(size_t, size_t required, size_t initial) noexcept {
+        return required + initial;
+    };
+};
+
+// Tag for the constructor that sets the initial capacity of an instance
+struct TVectorCapacity {
+    size_t value;
+};
+
+// Bit helpers
+inline size_t tvector_popcount(uint64_t word) noexcept {
+#if defined(_MSC_VER)
+    return static_cast<size_t>(__popcnt64(word));
+#else
+    return static_cast<size_t>(__builtin_popcountll(word));
+#endif
+}
+
+inline size_t tvector_ctz(uint64_t word) noexcept {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+}
+
+inline size_t tvector_clz(uint64_t word) noexcept {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return 63 - index;
+#else
+    return static_cast<size_t>(__builtin_clzll(word));
+#endif
+}
+
+// Slot states packed as bitmaps. Every 64 slots take two words:
+// the busy bits followed by the deleted bits, empty is neither.
+struct TVectorStateBits {
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    static constexpr size_t words(size_t slots) noexcept { return (slots + 63) / 64 * 2; };
+    static inline uint64_t busy_word(const uint64_t* bits, size_t group) noexcept { return bits[group * 2]; };
+    static inline uint64_t deleted_word(const uint64_t* bits, size_t group) noexcept { return bits[group * 2 + 1]; };
+    static inline bool is_busy(const uint64_t* bits, size_t slot) noexcept {
+        return (bits[slot / 64 * 2] >> (slot % 64)) & 1;
+    };
+    static inline bool is_deleted(const uint64_t* bits, size_t slot) noexcept {
+        return (bits[slot / 64 * 2 + 1] >> (slot % 64)) & 1;
+    };
+
+    static TVectorElemState get(const uint64_t*, size_t) noexcept;
+    static void set(uint64_t*, size_t, TVectorElemState) noexcept;
+    static void fill(uint64_t*, size_t, size_t, TVectorElemState) noexcept;
+    static size_t count_busy(const uint64_t*, size_t, size_t) noexcept;
+    static size_t next_busy(const uint64_t*, size_t, size_t) noexcept;
+    static size_t next_not_busy(const uint64_t*, size_t, size_t) noexcept;
+    static size_t prev_busy(const uint64_t*, size_t) noexcept;
+    static size_t select(uint64_t, size_t) noexcept;
+    static void shift_up(uint64_t*, size_t, size_t) noexcept;
+};
+
+inline TVectorElemState TVectorStateBits::get(const uint64_t* bits, size_t slot) noexcept {
+    if (is_busy(bits, slot)) return TVectorElemState::busy;
+    if (is_deleted(bits, slot)) return TVectorElemState::deleted;
+    return TVectorElemState::empty;
+}
+
+inline void TVectorStateBits::set(uint64_t* bits, size_t slot, TVectorElemState state) noexcept {
+    uint64_t mask = uint64_t(1) << (slot % 64);
+    uint64_t* group = bits + slot / 64 * 2;
+    group[0] &= ~mask;
+    group[1] &= ~mask;
+    if (state == TVectorElemState::busy) group[0] |= mask;
+    if (state == TVectorElemState::deleted) group[1] |= mask;
+}
+
+// Sets every slot in [from, to) to the given state
+inline void TVectorStateBits::fill(uint64_t* bits, size_t from, size_t to, TVectorElemState state) noexcept {
+    while (from < to) {
+        size_t group = from / 64;
+        size_t offset = from % 64;
+        size_t count = (to - from < 64 - offset) ? to - from : 64 - offset;
+        uint64_t mask = (count == 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << offset;
+        bits[group * 2] &= ~mask;
+        bits[group * 2 + 1] &= ~mask;
+        if (state == TVectorElemState::busy) bits[group * 2] |= mask;
+        if (state == TVectorElemState::deleted) bits[group * 2 + 1] |= mask;
+        from += count;
+    }
+}
+
+// Number of busy slots in [from, to)
+inline size_t TVectorStateBits::count_busy(const uint64_t* bits, size_t from, size_t to) noexcept {
+    size_t result = 0;
+    while (from < to) {
+        size_t offset = from % 64;
+        size_t count = (to - from < 64 - offset) ? to - from : 64 - offset;
+        uint64_t mask = (count == 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << offset;
+        result += tvector_popcount(busy_word(bits, from / 64) & mask);
+        from += count;
+    }
+    return result;
+}
+
+// First busy slot in [from, limit) or 'limit' if there is none
+inline size_t TVectorStateBits::next_busy(const uint64_t* bits, size_t from, size_t limit) noexcept {
+    if (from >= limit) return limit;
+    size_t group = from / 64;
+    uint64_t word = busy_word(bits, group) & (~uint64_t(0) << (from % 64));
+    size_t last_group = (limit - 1) / 64;
+    while (word == 0) {
+        if (++group > last_group) return limit;
+        word = busy_word(bits, group);
+    }
+    size_t slot = group * 64 + tvector_ctz(word);
+    return slot < limit ? slot : limit;
+}
+
+// First slot in [from, limit) that is not busy or 'limit' if there is none
+inline size_t TVectorStateBits::next_not_busy(const uint64_t* bits, size_t from, size_t limit) noexcept {
+    if (from >= limit) return limit;
+    size_t group = from / 64;
+    uint64_t word = ~busy_word(bits, group) & (~uint64_t(0) << (from % 64));
+    size_t last_group = (limit - 1) / 64;
+    while (word == 0) {
+        if (++group > last_group) return limit;
+        word = ~busy_word(bits, group);
+    }
+    size_t slot = group * 64 + tvector_ctz(word);
+    return slot < limit ? slot : limit;
+}
+
+// Last busy slot in [0, from] or 'npos' if there is none
+inline size_t TVectorStateBits::prev_busy(const uint64_t* bits, size_t from) noexcept {
+    size_t group = from / 64;
+    size_t offset = from % 64;
+    uint64_t word = busy_word(bits, group) & ((offset == 63) ? ~uint64_t(0) : (uint64_t(2) << offset) - 1);
+    while (word == 0) {
+        if (group == 0) return npos;
+        word = busy_word(bits, --group);
+    }
+    return group * 64 + 63 - tvector_clz(word);
+}
+
+// Position of the set bit of the given rank inside the word
+inline size_t TVectorStateBits::select(uint64_t word, size_t rank) noexcept {
+    for (size_t half = 32, base = 0; ; half /= 2) {
+        if (half == 0) return base;
+        size_t low = tvector_popcount(word & ((uint64_t(1) << half) - 1));
+        if (rank >= low) {
+            rank -= low;
+            word >>= half;
+            base += half;
+        }
+        else {
+            word &= (uint64_t(1) << half) - 1;
+        }
+    }
+}
+
+// Moves the states of slots [from, to) one slot up, slot 'from' becomes empty
+inline void TVectorStateBits::shift_up(uint64_t* bits, size_t from, size_t to) noexcept {
+    if (from >= to) return;
+    size_t first = from / 64;
+    size_t last = to / 64;
+    uint64_t low_mask = (uint64_t(1) << (from % 64)) - 1;
+    uint64_t high_mask = ~((uint64_t(2) << (to % 64)) - 1);
+    for (size_t k = 0; k < 2; k++) {
+        uint64_t first_word = bits[first * 2 + k];
+        uint64_t last_word = bits[last * 2 + k];
+        for (size_t group = last; group > first; group--) {
+            bits[group * 2 + k] = (bits[group * 2 + k] << 1) | (bits[(group - 1) * 2 + k] >> 63);
+        }
+        bits[first * 2 + k] = (first_word & low_mask) | ((first_word << 1) & ~low_mask & ~(low_mask + 1));
+        bits[last * 2 + k] = (last_word & high_mask) | (bits[last * 2 + k] & ~high_mask);
+    }
+}
+
+// Rank/select index over busy slots: a Fenwick tree of per-block busy counts.
+// It is only maintained while the owning vector is dirty. The cursor keeps
+// the last translated position so that sequential indexing stays O(1).
+class TVectorRankIndex {
+    std::vector<size_t> _tree;
+    size_t _blocks;
+    size_t _top;
+    mutable size_t _cursor_rank;
+    mutable size_t _cursor_slot;
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    TVectorRankIndex() : _blocks(0), _top(0), _cursor_rank(npos), _cursor_slot(0) {}
+
+    void build(const uint64_t*, size_t);
+    void update(size_t, bool);
+    size_t select(size_t, size_t&) const;
+    size_t prefix(size_t) const noexcept;
+    inline bool is_built() const noexcept { return _blocks != 0; };
+    inline void reset() noexcept { _blocks = 0; _cursor_rank = npos; };
+
+    inline size_t cursor_rank() const noexcept { return _cursor_rank; };
+    inline size_t cursor_slot() const noexcept { return _cursor_slot; };
+    inline void move_cursor(size_t rank, size_t slot) const noexcept {
+        _cursor_rank = rank;
+        _cursor_slot = slot;
+    };
+};
+
+inline void TVectorRankIndex::build(const uint64_t* states, size_t count) {
+    // The block count is rounded up to a power of two so that select()
+    // never has to check the tree bounds while descending.
+    _blocks = 1;
+    while (_blocks * RANK_BLOCK < count) _blocks *= 2;
+    _top = _blocks / 2;
+    _tree.assign(_blocks + 1, 0);
+    for (size_t i = 0; i * RANK_BLOCK < count; i++) {
+        size_t end = (i + 1) * RANK_BLOCK;
+        _tree[i + 1] = TVectorStateBits::count_busy(states, i * RANK_BLOCK, end < count ? end : count);
+    }
+    for (size_t i = 1; i <= _blocks; i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= _blocks) _tree[parent] += _tree[i];
+    }
+    _cursor_rank = npos;
+}
+
+inline void TVectorRankIndex::update(size_t slot, bool busy) {
+    _cursor_rank = npos;
+    for (size_t i = slot / RANK_BLOCK + 1; i <= _blocks; i += i & (~i + 1)) {
+        if (busy) _tree[i]++;
+        else _tree[i]--;
+    }
+}
+
+// Returns the block holding the busy slot of the given rank and stores
+// the rank of that slot inside the block in 'remainder'.
+inline size_t TVectorRankIndex::select(size_t rank, size_t& remainder) const {
+    size_t pos = 0;
+    for (size_t step = _top; step != 0; step /= 2) {
+        size_t value = _tree[pos + step];
+        bool right = value <= rank;
+        pos += right ? step : 0;
+        rank -= right ? value : 0;
+    }
+    remainder = rank;
+    return pos;
+}
+
+// Returns the number of busy slots in the blocks before 'block'
+inline size_t TVectorRankIndex::prefix(size_t block) const noexcept {
+    size_t result = 0;
+    for (size_t i = block; i > 0; i -= i & (~i + 1)) result += _tree[i];
+    return result;
+}
+
+// Allocators with T* reallocate(T*, size_t, size_t) can resize a buffer in
+// place (see TVectorAlignedAllocator); it returns nullptr when it cannot
+template<class Allocator, class = void> struct TVectorReallocatable : std::false_type {};
+template<class Allocator> struct TVectorReallocatable<Allocator, decltype(void(std::declval<Allocator&>().reallocate(
+    std::declval<typename std::allocator_traits<Allocator>::pointer>(), size_t(), size_t())))> : std::true_type {};
+
+// Inline storage for the small-buffer mode, empty when it is off
+template<class T, size_t Slots> class TVectorInlineBuffer {
+    alignas(T) unsigned char _inline_data[Slots * sizeof(T)];
+    uint64_t _inline_states[(Slots + 63) / 64 * 2];
+
+protected:
+    inline T* inline_data() const noexcept {
+        return reinterpret_cast<T*>(const_cast<unsigned char*>(_inline_data));
+    };
+    inline uint64_t* inline_states() const noexcept {
+        return const_cast<uint64_t*>(_inline_states);
+    };
+};
+
+template<class T> class TVectorInlineBuffer<T, 0> {
+protected:
+    inline T* inline_data() const noexcept { return nullptr; };
+    inline uint64_t* inline_states() const noexcept { return nullptr; };
+};
+
+// Chunked algorithms of TVectorParallel.h, they read the slots directly
+class TVectorParallel;
+// Copy-on-write handle of TCowVector.h, it compacts vectors before sharing them
+template<class T, class Growth, class Allocator, size_t Inline> class TCowVector;
+
+// With Inline != 0 up to Inline elements are stored inside the object, the
+// heap is only used once the vector grows past them
+template<class T, class Growth = TGeometricGrowth<>, class Allocator = std::allocator<T>, size_t Inline = 0>
+class TVector : private TVectorInlineBuffer<T, (Inline == 0) ? 0 : Inline + 1> {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using state_allocator = typename alloc_traits::template rebind_alloc<uint64_t>;
+
+    // One slot more than Inline: a vector always keeps a spare slot before growing
+    static constexpr size_t inline_slots = (Inline == 0) ? 0 : Inline + 1;
+
+    Allocator _alloc;
     T* _data;
-    TVectorElemState* _states;
+    uint64_t* _states;
+    size_t _front; // the live region is [_front, _front + _size)
     size_t _size;
     size_t _capacity;
     size_t _deleted;
+    size_t _initial_capacity;
     bool _is_clean;
+    TVectorRankIndex _rank;
+    TVectorCompaction _compaction;
+    // Incremental compaction: [_front, _compact_dst) is compacted, [_compact_dst, _compact_src) holds tombstones only
+    bool _compacting;
+    size_t _compact_dst;
+    size_t _compact_src;
+    TVECTOR_STAT(mutable TVectorStatsBlock _stats;)
+
+    // Elements that can be moved around with memcpy/memmove
+    static constexpr bool is_trivial = std::is_trivially_copyable<T>::value;
+
+    using TVectorInlineBuffer<T, inline_slots>::inline_data;
+    using TVectorInlineBuffer<T, inline_slots>::inline_states;
 
 public:
+    using allocator_type = Allocator;
+
     // Constructors
     TVector();
-    explicit TVector(size_t);
-    TVector(size_t, const T*);
-    explicit TVector(std::initializer_list<T>);
-    TVector(size_t, std::initializer_list<T>);
-    explicit TVector(const TVector<T>&);
+    explicit TVector(const Allocator&);
+    explicit TVector(TVectorCapacity, const Allocator& = Allocator());
+    explicit TVector(size_t, const Allocator& = Allocator());
+    TVector(size_t, const T*, const Allocator& = Allocator());
+    explicit TVector(std::initializer_list<T>, const Allocator& = Allocator());
+    TVector(size_t, std::initializer_list<T>, const Allocator& = Allocator());
+    explicit TVector(const TVector&);
+    TVector(const TVector&, const Allocator&);
     TVector(TVector&&) noexcept;
 
     // Destructor
     ~TVector();
 
     // Getters
-    inline T* data() const noexcept { return _data; };
+    inline T* data() const noexcept { return _data + _front; };
     inline size_t size() const noexcept { return _size - _deleted; };
     inline size_t capacity() const noexcept { return _capacity; };
+    inline size_t initial_capacity() const noexcept { return _initial_capacity; };
+    inline Allocator get_allocator() const noexcept { return _alloc; };
+    inline bool is_inline() const noexcept { return Inline != 0 && _data == inline_data(); };
     inline T& front() const { return at(0); };
     inline T& back() const { return at(size() - 1); };
-    inline T* begin() const;
-    inline T* end() const;
+
+    // Iterators visit busy slots only. On a clean vector they are plain
+    // pointer steps; on a dirty one ++/-- skip tombstones with word scans and
+    // jumps go through the rank index.
+    template<bool Const> class basic_iterator {
+        friend class TVector;
+        template<bool> friend class basic_iterator;
+        using owner_type = typename std::conditional<Const, const TVector, TVector>::type;
+
+        owner_type* _owner;
+        T* _ptr;
+        // Cached so that loops over a clean vector compile to pointer loops;
+        // iterators are invalidated by modifications anyway
+        bool _clean;
+
+        basic_iterator(owner_type* owner, T* ptr) noexcept : _owner(owner), _ptr(ptr), _clean(owner->_is_clean) {}
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<Const, const T*, T*>::type;
+        using reference = typename std::conditional<Const, const T&, T&>::type;
+
+        basic_iterator() noexcept : _owner(nullptr), _ptr(nullptr), _clean(true) {}
+        template<bool Other, class = typename std::enable_if<Const && !Other>::type>
+        basic_iterator(const basic_iterator<Other>& other) noexcept : _owner(other._owner), _ptr(other._ptr), _clean(other._clean) {}
+
+        inline reference operator*() const noexcept { return *_ptr; };
+        inline pointer operator->() const noexcept { return _ptr; };
+        inline reference operator[](difference_type offset) const { return *(*this + offset); };
+
+        inline basic_iterator& operator++() noexcept {
+            ++_ptr;
+            if (!_clean) skip_forward();
+            return *this;
+        };
+        inline basic_iterator operator++(int) noexcept {
+            basic_iterator result = *this;
+            ++*this;
+            return result;
+        };
+        inline basic_iterator& operator--() noexcept {
+            --_ptr;
+            if (!_clean) skip_backward();
+            return *this;
+        };
+        inline basic_iterator operator--(int) noexcept {
+            basic_iterator result = *this;
+            --*this;
+            return result;
+        };
+        inline basic_iterator& operator+=(difference_type offset) {
+            if (_clean) _ptr += offset;
+            else _ptr = _owner->_data + _owner->slot_of(index() + offset);
+            return *this;
+        };
+        inline basic_iterator& operator-=(difference_type offset) { return *this += -offset; };
+        inline basic_iterator operator+(difference_type offset) const {
+            basic_iterator result = *this;
+            return result += offset;
+        };
+        inline basic_iterator operator-(difference_type offset) const {
+            basic_iterator result = *this;
+            return result += -offset;
+        };
+        friend inline basic_iterator operator+(difference_type offset, const basic_iterator& it) { return it + offset; };
+        inline difference_type operator-(const basic_iterator& other) const noexcept {
+            if (_clean) return _ptr - other._ptr;
+            return index() - other.index();
+        };
+
+        inline bool operator==(const basic_iterator& other) const noexcept { return _ptr == other._ptr; };
+        inline bool operator!=(const basic_iterator& other) const noexcept { return _ptr != other._ptr; };
+        inline bool operator<(const basic_iterator& other) const noexcept { return _ptr < other._ptr; };
+        inline bool operator>(const basic_iterator& other) const noexcept { return _ptr > other._ptr; };
+        inline bool operator<=(const basic_iterator& other) const noexcept { return _ptr <= other._ptr; };
+        inline bool operator>=(const basic_iterator& other) const noexcept { return _ptr >= other._ptr; };
+
+    private:
+        // Kept out of operator++/-- so that the clean path stays a plain pointer step
+        void skip_forward() noexcept { _ptr = _owner->_data + _owner->next_slot(_ptr - _owner->_data); };
+        void skip_backward() noexcept { _ptr = _owner->_data + _owner->prev_slot(_ptr - _owner->_data); };
+        // Logical index of the element the iterator points to
+        inline difference_type index() const noexcept {
+            return static_cast<difference_type>(_owner->rank_of(_ptr - _owner->_data));
+        };
+    };
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    inline iterator begin() noexcept { return iterator(this, _data + first_slot()); };
+    inline iterator end() noexcept { return iterator(this, _data + _front + _size); };
+    inline const_iterator begin() const noexcept { return const_iterator(this, _data + first_slot()); };
+    inline const_iterator end() const noexcept { return const_iterator(this, _data + _front + _size); };
+    inline const_iterator cbegin() const noexcept { return begin(); };
+    inline const_iterator cend() const noexcept { return end(); };
 
     // Functions
     bool is_empty() const noexcept;
     bool is_full() const noexcept;
     T& at(size_t) const;
     void emplace(size_t, const T&);
-    void assign(const TVector<T>&);
+    void emplace(size_t, T&&);
+    void assign(const TVector&);
 
     // Insertion functions
     void push_front(const T&);
+    void push_front(T&&);
     void push_back(const T&);
+    void push_back(T&&);
     void insert(size_t, const T&);
+    void insert(size_t, T&&);
+    template<class... Args> T& emplace_front(Args&&...);
+    template<class... Args> T& emplace_back(Args&&...);
+    template<class... Args> T& emplace_at(size_t, Args&&...);
+    template<class Iterator, class = typename std::iterator_traits<Iterator>::iterator_category> void insert(size_t, Iterator, Iterator);
+    template<class Iterator, class = typename std::iterator_traits<Iterator>::iterator_category> void append(Iterator, Iterator);
 
     // Deletion functions
     void pop_front();
     void pop_back();
     void erase(size_t);
+    void erase(const std::vector<size_t>&);
+    template<class Predicate> size_t erase_if(Predicate);
 
     // Memory management functions
     void clear() noexcept;
     void shrink_to_fit();
     void reserve(size_t);
     void resize(size_t);
+    void compact();
+    bool compact_step(size_t);
+    inline TVectorCompaction compaction() const noexcept { return _compaction; };
+    inline void set_compaction(TVectorCompaction mode) noexcept { _compaction = mode; };
+
+    // Statistics, zeros unless TVECTOR_STATS is defined
+    TVectorStats stats() const noexcept;
+    void reset_stats() noexcept;
+
+    // Serialization functions, tombstones are left out of the output
+    void save(std::ostream&) const;
+    void save(std::vector<char>&) const;
+    void load(std::istream&);
+    size_t load(const char*, size_t);
 
     // Operators overload
-    void operator=(const TVector<T>&);
-    TVector& operator=(TVector&&) noexcept;
-    bool operator==(const TVector<T>&) const;
-    bool operator!=(const TVector<T>&) const;
+    void operator=(const TVector&);
+    TVector& operator=(TVector&&) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                           alloc_traits::is_always_equal::value);
+    bool operator==(const TVector&) const;
+    bool operator!=(const TVector&) const;
     T& operator[](size_t) const;
 
+    // Friend functions
+    template<class U, class G, class A, size_t I> friend int find_first(const TVector<U, G, A, I>&, const U&);
+    template<class U, class G, class A, size_t I> friend int find_last(const TVector<U, G, A, I>&, const U&);
+    template<class U, class G, class A, size_t I> friend std::vector<int> find_all(const TVector<U, G, A, I>&, const U&);
+    friend class TVectorParallel;
+    template<class U> friend class TVectorStreamReader;
+    template<class U, class G, class A, size_t I> friend class TCowVector;
+
 private:
     void cleanup();
+    void compact_tick();
+    void finish_compaction() noexcept;
     size_t translate_index(size_t) const;
     void swap_elements(size_t, size_t);
+    void mark_deleted(size_t);
+    void mark_busy(size_t);
+    void grow(size_t, bool = false);
+    void make_room(bool);
+    void make_room_back(size_t);
+    T* claim_back(size_t);
+    void commit_back(size_t);
+    template<class... Args> void insert_slot(size_t, Args&&...);
+    void finish_erase();
+    void move_region(size_t);
+    template<class... Args> void construct_at(size_t, Args&&...);
+    void steal(TVector&) noexcept;
+    void reset_buffers() noexcept;
+
+    T* allocate_data(size_t);
+    void deallocate_data(T*, size_t) noexcept;
+    uint64_t* allocate_states(size_t);
+    void deallocate_states(uint64_t*, size_t) noexcept;
+    void allocate();
+    void reallocate(size_t, size_t = 0);
+    bool reallocate_in_place(size_t, size_t);
+    void destroy_elements() noexcept;
+    void release() noexcept;
+    void value_construct_n(T*, size_t);
+    template<class Iterator> void copy_construct_n(Iterator, size_t, T*);
+
+    // Elements are constructed and destroyed through the allocator
+    template<class... Args> inline void construct_element(T* place, Args&&... args) {
+        alloc_traits::construct(_alloc, place, std::forward<Args>(args)...);
+    };
+    inline void destroy_element(T* place) noexcept {
+        alloc_traits::destroy(_alloc, place);
+    };
+    inline void destroy_n(T* first, size_t count) noexcept {
+        for (size_t i = 0; i < count; i++) destroy_element(first + i);
+    };
+    // Moves the element and the state of slot 'from' to the free slot 'to', 'from' becomes empty
+    inline void relocate_slot(size_t from, size_t to) {
+        if (is_busy(from)) {
+            construct_element(_data + to, std::move_if_noexcept(_data[from]));
+            destroy_element(_data + from);
+        }
+        set_state(to, state(from));
+        set_state(from, TVectorElemState::empty);
+    };
+
+    inline TVectorElemState state(size_t index) const noexcept {
+        return TVectorStateBits::get(_states, index);
+    };
+    inline bool is_busy(size_t index) const noexcept {
+        return TVectorStateBits::is_busy(_states, index);
+    };
+    inline void set_state(size_t index, TVectorElemState value) noexcept {
+        TVectorStateBits::set(_states, index, value);
+    };
+    static constexpr size_t default_capacity(size_t size) noexcept {
+        if (size < inline_slots) return inline_slots;
+        return (size == 0) ? CAPACITY : size + CAPACITY;
+    };
+    // True when a push at that end needs neither a reallocation nor a move of the region
+    inline bool has_room(bool front) const noexcept {
+        return _size + 1 < _capacity && (front ? _front > 0 : _front + _size < _capacity);
+    };
+    inline void mark_clean() noexcept {
+        _is_clean = true;
+        _compacting = false;
+        _rank.reset();
+    };
+    // Slot helpers for the iterators, 'slot' may be one past the live region
+    inline size_t first_slot() const noexcept {
+        if (_is_clean || _size == 0 || is_busy(_front)) return _front;
+        return TVectorStateBits::next_busy(_states, _front, _front + _size);
+    };
+    inline size_t next_slot(size_t slot) const noexcept {
+        if (slot >= _front + _size || is_busy(slot)) return slot;
+        return TVectorStateBits::next_busy(_states, slot, _front + _size);
+    };
+    inline size_t prev_slot(size_t slot) const noexcept {
+        if (is_busy(slot)) return slot;
+        return TVectorStateBits::prev_busy(_states, slot);
+    };
+    inline size_t rank_of(size_t slot) const noexcept {
+        if (_is_clean) return slot - _front;
+        size_t block = slot / RANK_BLOCK;
+        return _rank.prefix(block) + TVectorStateBits::count_busy(_states, block * RANK_BLOCK, slot);
+    };
+    inline size_t slot_of(size_t index) const {
+        return (index == size()) ? _front + _size : translate_index(index);
+    };
+    inline bool owns(const T& value) const noexcept {
+        const T* address = std::addressof(value);
+        return !std::less<const T*>()(address, _data) && std::less<const T*>()(address, _data + _capacity);
+    };
+    // Calls function(first, count) for every maximal run of busy slots
+    template<class Function> void for_each_busy_run(Function function) const {
+        for_each_busy_run(_front / 64, (_front + _size + 63) / 64, function);
+    };
+    // Same over the state words [first_group, end_group), runs are cut at the range ends
+    template<class Function> void for_each_busy_run(size_t first_group, size_t end_group, Function function) const {
+        size_t first = 0;
+        size_t count = 0;
+        for (size_t group = first_group; group < end_group; group++) {
+            uint64_t word = TVectorStateBits::busy_word(_states, group);
+            while (word != 0) {
+                size_t start = tvector_ctz(word);
+                uint64_t rest = ~(word >> start);
+                size_t length = (rest == 0) ? 64 - start : tvector_ctz(rest);
+                if (first + count == group * 64 + start) {
+                    count += length;
+                }
+                else {
+                    if (count != 0) function(first, count);
+                    first = group * 64 + start;
+                    count = length;
+                }
+                word = (start + length == 64) ? 0 : word & (~uint64_t(0) << (start + length));
+            }
+        }
+        if (count != 0) function(first, count);
+    };
+    // Short runs are copied element by element, memmove only pays off on long ones
+    static inline void move_run(T* destination, const T* source, size_t count) noexcept {
+        if (count >= 16) {
+            std::memmove(destination, source, count * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < count; i++) std::memcpy(destination + i, source + i, sizeof(T));
+    };
+    // Compares the busy slots with 'value' one state word at a time and calls
+    // function(rank, busy, matches) for every word with matches, where 'rank'
+    // is the logical index of the first busy slot of the word. Stops once the
+    // function returns false.
+    template<class Function> void match_words(const T& value, bool backwards, Function function) const {
+        if (_size == 0) return;
+        match_words(value, _front / 64, (_front + _size + 63) / 64, backwards ? size() : 0, backwards, function);
+    };
+    // Same over the state words [first_group, end_group). 'rank' is the logical
+    // index of the first busy slot of the range, or one past its last one when
+    // searching backwards.
+    template<class Function> void match_words(const T& value, size_t first_group, size_t end_group, size_t rank, bool backwards, Function function) const {
+        if (first_group >= end_group) return;
+        size_t last_group = end_group - 1;
+        TVectorMatcher<T> matcher = nullptr;
+        if constexpr (TVectorSimdSupported<T>::value) matcher = tvector_matcher<T>();
+        // The kernels compare the whole span between the first and the last
+        // busy slot; other types only compare live slots, tombstones hold
+        // destroyed objects
+        auto match = [&](size_t group, uint64_t busy) {
+            if constexpr (TVectorSimdSupported<T>::value) {
+                size_t low = tvector_ctz(busy);
+                size_t high = 64 - tvector_clz(busy);
+                return (matcher(_data + group * 64 + low, high - low, value) << low) & busy;
+            }
+            else {
+                uint64_t result = 0;
+                for (uint64_t word = busy; word != 0; word &= word - 1) {
+                    size_t bit = tvector_ctz(word);
+                    if (_data[group * 64 + bit] == value) result |= uint64_t(1) << bit;
+                }
+                return result;
+            }
+        };
+        for (size_t k = 0; k <= last_group - first_group; k++) {
+            size_t group = backwards ? last_group - k : first_group + k;
+            uint64_t busy = TVectorStateBits::busy_word(_states, group);
+            if (busy == 0) continue;
+            size_t count = tvector_popcount(busy);
+            if (backwards) rank -= count;
+            uint64_t matches = match(group, busy);
+            if (matches != 0 && !function(rank, busy, matches)) return;
+            if (!backwards) rank += count;
+        }
+    };
+    template<class Function> void for_each_busy(Function function) const {
+        for (size_t group = _front / 64; group * 64 < _front + _size; group++) {
+            uint64_t word = TVectorStateBits::busy_word(_states, group);
+            while (word != 0) {
+                function(group * 64 + tvector_ctz(word));
+                word &= word - 1;
+            }
+        }
+    };
 };
 
 // Realization
 
 // Constructors
-template<class T> TVector<T>::TVector() :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector() :
+    TVector(TVectorCapacity{ default_capacity(0) }, Allocator())
+{
+    _initial_capacity = CAPACITY;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(const Allocator& alloc) :
+    TVector(TVectorCapacity{ default_capacity(0) }, alloc)
+{
+    _initial_capacity = CAPACITY;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(TVectorCapacity initial, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
+    _front(0),
     _size(0),
-    _capacity(CAPACITY),
+    _capacity(initial.value),
     _deleted(0),
-    _is_clean(true)
+    _initial_capacity(initial.value),
+    _is_clean(true),
+    _compaction(TVectorCompaction::eager),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
-    _data = new T[_capacity];
-    _states = new TVectorElemState[_capacity];
-    for (int i = 0; i < _capacity; i++) _states[i] = TVectorElemState::empty;
+    allocate();
 }
 
-template<class T> TVector<T>::TVector(size_t size) :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(size_t size, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
+    _front(0),
     _size(size),
-    _capacity(CAPACITY),
+    _capacity(default_capacity(size)),
     _deleted(0),
-    _is_clean(true)
+    _initial_capacity(CAPACITY),
+    _is_clean(true),
+    _compaction(TVectorCompaction::eager),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
     if (size < 0) throw std::invalid_argument("TVector.size_constructor: Invalid argument 'size' - must be >= 0");
-    if (_size == 0) {
-        _data = new T[_capacity];
-        _states = new TVectorElemState[_capacity];
-        for (int i = 0; i < _capacity; i++) _states[i] = TVectorElemState::empty;
+    allocate();
+    try {
+        value_construct_n(_data, _size);
     }
-    else {
-        _capacity = _size + CAPACITY;
-        _data = new T[_capacity];
-        _states = new TVectorElemState[_capacity];
-        for (int i = 0; i < _size; i++) {
-            _states[i] = TVectorElemState::busy;
-        }
-        for (int i = _size; i < _capacity; i++) {
-            _states[i] = TVectorElemState::empty;
-        }
+    catch (...) {
+        release();
+        throw;
     }
+    TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
 }
 
-template<class T> TVector<T>::TVector(size_t size, const T* data) :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(size_t size, const T* data, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
+    _front(0),
     _size(size),
-    _capacity(size + CAPACITY),
+    _capacity(default_capacity(size)),
     _deleted(0),
-    _is_clean(true)
+    _initial_capacity(CAPACITY),
+    _is_clean(true),
+    _compaction(TVectorCompaction::eager),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
     if (size < 0) {
         throw std::invalid_argument("TVector.sizedata_constructor: Invalid argument 'size' - must be >= 0");
@@ -133,302 +834,628 @@ template<class T> TVector<T>::TVector(size_t size, const T* data) :
     if (data == nullptr && size > 0) {
         throw std::invalid_argument("TVector.size_constructor: Invalid argument 'data' - is nullptr");
     }
-    _data = new T[_capacity];
-    _states = new TVectorElemState[_capacity];
-    for (size_t i = 0; i < _size; i++) {
-        _data[i] = data[i];
-        _states[i] = TVectorElemState::busy;
+    allocate();
+    try {
+        copy_construct_n(data, _size, _data);
     }
-    for (size_t i = _size; i < _capacity; i++) {
-        _states[i] = TVectorElemState::empty;
+    catch (...) {
+        release();
+        throw;
     }
+    TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
 }
 
-template<class T> TVector<T>::TVector(std::initializer_list<T> init) :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(std::initializer_list<T> init, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
+    _front(0),
     _size(init.size()),
-    _capacity(init.size() + CAPACITY),
+    _capacity(default_capacity(init.size())),
     _deleted(0),
-    _is_clean(true)
+    _initial_capacity(CAPACITY),
+    _is_clean(true),
+    _compaction(TVectorCompaction::eager),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
-    if (init.size() > 0) {
-        _data = new T[_capacity];
-        _states = new TVectorElemState[_capacity];
-        const T* src = init.begin();
-        for (size_t i = 0; i < _size; i++) {
-            _data[i] = src[i];
-            _states[i] = TVectorElemState::busy;
-        }
-        for (size_t i = _size; i < _capacity; i++) {
-            _states[i] = TVectorElemState::empty;
-        }
+    allocate();
+    try {
+        copy_construct_n(init.begin(), _size, _data);
     }
+    catch (...) {
+        release();
+        throw;
+    }
+    TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
 }
 
-template<class T> TVector<T>::TVector(size_t size, std::initializer_list<T> init) :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(size_t size, std::initializer_list<T> init, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
+    _front(0),
     _size(size),
-    _capacity(size + CAPACITY),
+    _capacity(default_capacity(size)),
     _deleted(0),
-    _is_clean(true)
+    _initial_capacity(CAPACITY),
+    _is_clean(true),
+    _compaction(TVectorCompaction::eager),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
     if (size <= 0) {
         throw std::invalid_argument("TVector.sizeinitlist_constructor: Invalid argument 'size' - must be > 0");
     }
-    _data = new T[_capacity];
-    _states = new TVectorElemState[_capacity];
-    const T* src = init.begin();
-    for (size_t i = 0; i < _size; i++) {
-        _data[i] = src[i];
-        _states[i] = TVectorElemState::busy;
+    size_t copied = (init.size() < _size) ? init.size() : _size;
+    allocate();
+    try {
+        copy_construct_n(init.begin(), copied, _data);
+        try {
+            value_construct_n(_data + copied, _size - copied);
+        }
+        catch (...) {
+            destroy_n(_data, copied);
+            throw;
+        }
     }
-    for (size_t i = _size; i < _capacity; i++) {
-        _states[i] = TVectorElemState::empty;
+    catch (...) {
+        release();
+        throw;
     }
+    TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
 }
 
-template<class T> TVector<T>::TVector(const TVector<T>& other) :
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(const TVector& other) :
+    TVector(other, alloc_traits::select_on_container_copy_construction(other._alloc))
+{}
+
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(const TVector& other, const Allocator& alloc) :
+    _alloc(alloc),
     _data(nullptr),
     _states(nullptr),
-    _size(other._size),
-    _capacity(other._capacity),
-    _deleted(other._deleted),
-    _is_clean(other._is_clean)
+    _front(0),
+    _size(other.size()),
+    _capacity((other.size() < inline_slots) ? inline_slots : other._capacity),
+    _deleted(0),
+    _initial_capacity(other._initial_capacity),
+    _is_clean(true),
+    _compaction(other._compaction),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
-    _data = new T[_capacity];
-    _states = new TVectorElemState[_capacity];
-    for (size_t i = 0; i < _capacity; i++) {
-        _data[i] = other._data[i];
-        _states[i] = other._states[i];
+    // The copy is compacted: tombstones of 'other' are not carried over
+    allocate();
+    size_t index = 0;
+    if constexpr (is_trivial) {
+        other.for_each_busy_run([&](size_t first, size_t count) {
+            move_run(_data + index, other._data + first, count);
+            index += count;
+        });
+        TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
+        return;
     }
+    try {
+        other.for_each_busy([&](size_t slot) {
+            construct_element(_data + index, other._data[slot]);
+            index++;
+        });
+    }
+    catch (...) {
+        destroy_n(_data, index);
+        release();
+        throw;
+    }
+    TVectorStateBits::fill(_states, 0, _size, TVectorElemState::busy);
 }
 
-template<class T> TVector<T>::TVector(TVector&& other) noexcept :
-    _data(std::exchange(other._data, nullptr)),
-    _size(std::exchange(other._size, 0)),
-    _capacity(std::exchange(other._capacity, CAPACITY)),
-    _deleted(std::exchange(other._deleted, 0)),
-    _states(std::exchange(other._states, nullptr)),
-    _is_clean(std::exchange(other._is_clean, true))
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::TVector(TVector&& other) noexcept :
+    _alloc(std::move(other._alloc)),
+    _data(nullptr),
+    _states(nullptr),
+    _front(0),
+    _size(0),
+    _capacity(0),
+    _deleted(0),
+    _initial_capacity(other._initial_capacity),
+    _is_clean(true),
+    _compaction(other._compaction),
+    _compacting(false),
+    _compact_dst(0),
+    _compact_src(0)
 {
-
+    steal(other);
 }
 
 
 // Destructor
-template<class T> TVector<T>::~TVector() {
-    if (_data != nullptr) {
-        delete[] _data;
-        delete[] _states;
-    }
+template<class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>::~TVector() {
+    release();
 }
 
 // Functions
-template<class T> bool TVector<T>::is_empty() const noexcept {
-    if (size() == 0) return true;
-    for (size_t i = 0; i < size(); i++) {
-        if (_states[i] == TVectorElemState::busy) return false;
-    }
-    return true;
+template<class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::is_empty() const noexcept {
+    return size() == 0;
 }
 
-template<class T> bool TVector<T>::is_full() const noexcept {
+template<class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::is_full() const noexcept {
     return size() >= _capacity;
 }
 
-template<class T> T& TVector<T>::at(size_t index) const {
+template<class T, class Growth, class Allocator, size_t Inline> T& TVector<T, Growth, Allocator, Inline>::at(size_t index) const {
     if (index >= size() || index < 0) {
         throw std::out_of_range("TVector.at: 'index' out of range or vector is empty");
     }
-    if (_is_clean) return _data[index];
+    if (_is_clean) return _data[_front + index];
     else return _data[translate_index(index)];
 }
 
-template<class T> void TVector<T>::emplace(size_t index, const T& value) {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::emplace(size_t index, const T& value) {
     if (index >= size() || index < 0) {
         throw std::out_of_range("TVector.emplace: 'index' out of range or vector is empty");
     }
     at(index) = value;
 }
 
-template<class T> void TVector<T>::assign(const TVector<T>& other) {
-    delete[] _states;
-    delete[] _data;
-    _size = other._size;
-    _capacity = other._capacity;
-    _data = new T[_capacity];
-    _states = new TVectorElemState[_capacity];
-    _deleted = other._deleted;
-    _is_clean = other._is_clean;
-    for (size_t i = 0; i < _capacity; i++) {
-        _data[i] = other._data[i];
-        _states[i] = other._states[i];
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::emplace(size_t index, T&& value) {
+    if (index >= size() || index < 0) {
+        throw std::out_of_range("TVector.emplace: 'index' out of range or vector is empty");
     }
+    at(index) = std::move(value);
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::assign(const TVector& other) {
+    if (this == &other) return;
+    TVector copy(other);
+    *this = std::move(copy);
 }
 
 // Insertion functions
-template<class T> void TVector<T>::push_front(const T& value) {
-    if (_size == 0) _size++;
-    if (_states[0] == TVectorElemState::busy) {
-        _size++;
-        if (is_full()) reserve(_size + CAPACITY);
-        swap_elements(_size - 1, 0);
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::push_front(const T& value) {
+    emplace_front(value);
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::push_front(T&& value) {
+    emplace_front(std::move(value));
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::push_back(const T& value) {
+    emplace_back(value);
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::push_back(T&& value) {
+    emplace_back(std::move(value));
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::insert(size_t index, const T& value) {
+    if (owns(value)) {
+        insert_slot(index, T(value));
+        return;
     }
-    if (_states[0] == TVectorElemState::deleted) _deleted--;
-    if (_size == size()) _is_clean = true;
-    _data[0] = value;
-    _states[0] = TVectorElemState::busy;
+    insert_slot(index, value);
 }
 
-template<class T> void TVector<T>::push_back(const T& value) {
-    if (_size == 0) _size++;
-    if (_states[_size - 1] == TVectorElemState::busy) {
-        _size++;
-        if (is_full()) reserve(_size + CAPACITY);
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::insert(size_t index, T&& value) {
+    if (owns(value)) {
+        insert_slot(index, T(std::move(value)));
+        return;
     }
-    if (_states[_size - 1] == TVectorElemState::deleted) _deleted--;
-    if (_size == size()) _is_clean = true;
-    _data[_size - 1] = value;
-    _states[_size - 1] = TVectorElemState::busy;
+    insert_slot(index, std::move(value));
 }
 
-template<class T> void TVector<T>::insert(size_t index, const T& value) {
+// The element is built right in its slot. Only when the buffer has to grow or
+// the region has to move it is built aside first, since the arguments may
+// refer to elements of the vector.
+template<class T, class Growth, class Allocator, size_t Inline> template<class... Args> T& TVector<T, Growth, Allocator, Inline>::emplace_front(Args&&... args) {
+    if (has_room(true)) {
+        construct_at(_front - 1, std::forward<Args>(args)...);
+    }
+    else {
+        T value(std::forward<Args>(args)...);
+        make_room(true);
+        construct_at(_front - 1, std::move(value));
+    }
+    _front--;
     _size++;
-    size_t real_index = translate_index(index);
-    if (is_full()) reserve(_size + CAPACITY);
-    swap_elements(_size - 1, real_index);
-    _data[real_index] = value;
-    _states[real_index] = TVectorElemState::busy;
+    compact_tick();
+    return _data[_front];
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> template<class... Args> T& TVector<T, Growth, Allocator, Inline>::emplace_back(Args&&... args) {
+    if (has_room(false)) {
+        construct_at(_front + _size, std::forward<Args>(args)...);
+    }
+    else {
+        T value(std::forward<Args>(args)...);
+        make_room(false);
+        construct_at(_front + _size, std::move(value));
+    }
+    _size++;
+    compact_tick();
+    // A compaction step may have moved the new element down
+    return _data[prev_slot(_front + _size - 1)];
+}
+
+// Inside the region the tail is shifted before the slot is filled, so the
+// element is built aside unless it goes to one of the ends
+template<class T, class Growth, class Allocator, size_t Inline> template<class... Args> T& TVector<T, Growth, Allocator, Inline>::emplace_at(size_t index, Args&&... args) {
+    if (index > size()) {
+        throw std::out_of_range("TVector.emplace_at: 'index' out of range");
+    }
+    if (index == 0) return emplace_front(std::forward<Args>(args)...);
+    if (index == size()) return emplace_back(std::forward<Args>(args)...);
+    insert_slot(index, T(std::forward<Args>(args)...));
+    return at(index);
+}
+
+// Inserts [first, last) before logical index 'index' with a single reservation
+// and one shift of the tail. The vector is compacted first, so an insert into
+// a vector with tombstones also drops them.
+template<class T, class Growth, class Allocator, size_t Inline> template<class Iterator, class> void TVector<T, Growth, Allocator, Inline>::insert(size_t index, Iterator first, Iterator last) {
+    if (index > size()) {
+        throw std::out_of_range("TVector.insert: 'index' out of range");
+    }
+    using category = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (!std::is_base_of<std::forward_iterator_tag, category>::value) {
+        // Single pass input: the count is only known after reading it
+        std::vector<T> buffer(first, last);
+        insert(index, std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+    }
+    else {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count == 0) return;
+        if constexpr (std::is_same<typename std::iterator_traits<Iterator>::value_type, T>::value) {
+            if (owns(*first)) {
+                std::vector<T> buffer(first, last);
+                insert(index, std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+                return;
+            }
+        }
+        if (index == size()) {
+            append(first, last);
+            return;
+        }
+        cleanup();
+        make_room_back(count);
+        size_t position = _front + index;
+        size_t end = _front + _size;
+        size_t built = 0;
+        if constexpr (is_trivial) {
+            // The tail is shifted first and shifted back if an element cannot be built
+            std::memmove(_data + position + count, _data + position, (end - position) * sizeof(T));
+            try {
+                for (; built < count; built++, ++first) construct_element(_data + position + built, *first);
+            }
+            catch (...) {
+                std::memmove(_data + position, _data + position + count, (end - position) * sizeof(T));
+                throw;
+            }
+        }
+        else {
+            // The new elements are built behind the tail and rotated into place
+            try {
+                for (; built < count; built++, ++first) construct_element(_data + end + built, *first);
+            }
+            catch (...) {
+                destroy_n(_data + end, built);
+                throw;
+            }
+            std::rotate(_data + position, _data + end, _data + end + count);
+        }
+        TVectorStateBits::fill(_states, end, end + count, TVectorElemState::busy);
+        _size += count;
+    }
+}
+
+// Appends [first, last), forward ranges reserve their room once
+template<class T, class Growth, class Allocator, size_t Inline> template<class Iterator, class> void TVector<T, Growth, Allocator, Inline>::append(Iterator first, Iterator last) {
+    using category = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (!std::is_base_of<std::forward_iterator_tag, category>::value) {
+        for (; first != last; ++first) push_back(*first);
+    }
+    else {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count == 0) return;
+        if constexpr (std::is_same<typename std::iterator_traits<Iterator>::value_type, T>::value) {
+            if (owns(*first)) {
+                std::vector<T> buffer(first, last);
+                append(std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+                return;
+            }
+        }
+        make_room_back(count);
+        for (; first != last; ++first) {
+            construct_at(_front + _size, *first);
+            _size++;
+        }
+        compact_tick();
+    }
 }
 
 // Deletion functions
-template<class T> void TVector<T>::pop_front() {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::pop_front() {
     if (is_empty()) {
         throw std::logic_error("TVector.pop_front: Impossible to delete - there are no elements in the vector");
     }
-    _states[translate_index(0)] = TVectorElemState::deleted;
-    _deleted++;
-    _is_clean = false;
-    if (_deleted >= static_cast<size_t>(_size * DELETED_LIMIT)) {
-        cleanup();
+    // The first slot of the live region is always busy, tombstones right behind it are dropped as well
+    size_t index = _front;
+    destroy_element(_data + index);
+    size_t next = (size() == 1) ? _front + _size : TVectorStateBits::next_busy(_states, index + 1, _front + _size);
+    _deleted -= next - index - 1;
+    TVectorStateBits::fill(_states, index, next, TVectorElemState::empty);
+    _size -= next - index;
+    _front = (_size == 0) ? 0 : next;
+    if (_is_clean) return;
+    if (_deleted == 0) {
+        mark_clean();
+        return;
+    }
+    _rank.update(index, false);
+    if (_compacting && _front > _compact_dst) {
+        _compact_dst = _front;
+        _compact_src = _front;
     }
+    compact_tick();
 }
 
-template<class T> void TVector<T>::pop_back() {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::pop_back() {
     if (is_empty()) {
         throw std::logic_error("TVector.pop_back: Impossible to delete - there are no elements in the vector");
     }
-    size_t index = 0;
-    for (int i = _size - 1; i >= 0; i--) {
-        if (_states[i] == TVectorElemState::busy) {
-            index = i;
-            break;
-        }
+    size_t end = _front + _size;
+    size_t index = TVectorStateBits::prev_busy(_states, end - 1);
+    destroy_element(_data + index);
+    _deleted -= end - 1 - index;
+    TVectorStateBits::fill(_states, index, end, TVectorElemState::empty);
+    _size = index - _front;
+    if (_size == 0) _front = 0;
+    if (_is_clean) return;
+    if (_deleted == 0) {
+        mark_clean();
+        return;
     }
-    _states[index] = TVectorElemState::empty;
-    _size--;
+    _rank.update(index, false);
+    if (_compacting && index <= _compact_dst) _compacting = false;
+    compact_tick();
 }
 
-template<class T> void TVector<T>::erase(size_t index) {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::erase(size_t index) {
     if (is_empty()) {
         throw std::logic_error("TVector.erase: Impossible to delete - there are no elements in the vector");
     }
-    size_t real_index = translate_index(index);
-    if (real_index == size() - 1) {
+    if (index == 0) {
+        pop_front();
+        return;
+    }
+    if (index == size() - 1) {
         pop_back();
         return;
     }
-    _states[real_index] = TVectorElemState::deleted;
-    _deleted++;
-    _is_clean = false;
-    if (_deleted >= static_cast<size_t>(_size * DELETED_LIMIT)) {
+    size_t real_index = translate_index(index);
+    destroy_element(_data + real_index);
+    mark_deleted(real_index);
+    if (_compaction == TVectorCompaction::incremental) {
+        compact_tick();
+    }
+    else if (_deleted >= static_cast<size_t>(_size * DELETED_LIMIT)) {
         cleanup();
     }
 }
 
+// Erases the elements at the given logical indices, which must be strictly
+// increasing. The slots are found in one walk over the state words and the
+// vector is compacted at most once, after all of them are gone.
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::erase(const std::vector<size_t>& indices) {
+    if (indices.empty()) return;
+    if (is_empty()) {
+        throw std::logic_error("TVector.erase: Impossible to delete - there are no elements in the vector");
+    }
+    for (size_t i = 1; i < indices.size(); i++) {
+        if (indices[i] <= indices[i - 1]) {
+            throw std::invalid_argument("TVector.erase: 'indices' must be strictly increasing");
+        }
+    }
+    if (indices.back() >= size()) {
+        throw std::out_of_range("TVector.erase: 'indices' out of range");
+    }
+    size_t next = 0;
+    size_t rank = 0;
+    for (size_t group = _front / 64; next < indices.size(); group++) {
+        uint64_t word = TVectorStateBits::busy_word(_states, group);
+        size_t count = tvector_popcount(word);
+        while (next < indices.size() && indices[next] < rank + count) {
+            size_t slot = group * 64 + TVectorStateBits::select(word, indices[next] - rank);
+            destroy_element(_data + slot);
+            set_state(slot, TVectorElemState::deleted);
+            next++;
+        }
+        rank += count;
+    }
+    _deleted += indices.size();
+    finish_erase();
+}
+
+// Erases every element for which predicate(element) is true, returns their number
+template<class T, class Growth, class Allocator, size_t Inline> template<class Predicate> size_t TVector<T, Growth, Allocator, Inline>::erase_if(Predicate predicate) {
+    size_t removed = 0;
+    try {
+        for_each_busy([&](size_t slot) {
+            if (!predicate(static_cast<const T&>(_data[slot]))) return;
+            destroy_element(_data + slot);
+            set_state(slot, TVectorElemState::deleted);
+            _deleted++;
+            removed++;
+        });
+    }
+    catch (...) {
+        if (removed != 0) finish_erase();
+        throw;
+    }
+    if (removed != 0) finish_erase();
+    return removed;
+}
+
 // Memory management functions
-template<class T> void TVector<T>::clear() noexcept {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::clear() noexcept {
+    destroy_elements();
+    TVectorStateBits::fill(_states, _front, _front + _size, TVectorElemState::empty);
+    _front = 0;
     _size = 0;
     _deleted = 0;
-    _is_clean = true;
-    for (size_t i = 0; i < _capacity; i++) _states[i] = TVectorElemState::empty;
+    mark_clean();
 }
 
-template<class T> void TVector<T>::shrink_to_fit() {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::shrink_to_fit() {
     cleanup();
-    if (_size < _capacity) {
-        T* new_data = new T[_size];
-        TVectorElemState* new_states = new TVectorElemState[_size];
-        for (size_t i = 0; i < _size; i++) {
-            new_data[i] = _data[i];
-            new_states[i] = _states[i];
-        }
-        delete[] _data;
-        delete[] _states;
-        _data = new_data;
-        _states = new_states;
-        _capacity = _size;
-    }
+    if (_size < _capacity) reallocate(_size);
 }
 
-template<class T> void TVector<T>::reserve(size_t new_capacity) {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::reserve(size_t new_capacity) {
     cleanup();
-    if (new_capacity > _capacity) {
-        T* new_data = new T[new_capacity];
-        TVectorElemState* new_states = new TVectorElemState[new_capacity];
-        for (size_t i = 0; i < _capacity; i++) {
-            new_data[i] = _data[i];
-            new_states[i] = _states[i];
-        }
-        for (size_t i = _capacity; i < new_capacity; i++) new_states[i] = TVectorElemState::empty;
-        delete[] _data;
-        delete[] _states;
-        _data = new_data;
-        _states = new_states;
-        _capacity = new_capacity;
-    }
+    if (new_capacity > _capacity) reallocate(new_capacity);
 }
 
-template<class T> void TVector<T>::resize(size_t new_size) {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::resize(size_t new_size) {
     if (new_size < 0) {
         throw std::invalid_argument("TVector.resize: Invalid argument 'new_size' - must be >= 0");
     }
     cleanup();
     if (new_size == size()) return;
     if (new_size < size()) {
-        for (size_t i = new_size; i < _size; i++) _states[i] = TVectorElemState::empty;
+        destroy_n(_data + _front + new_size, _size - new_size);
+        TVectorStateBits::fill(_states, _front + new_size, _front + _size, TVectorElemState::empty);
     }
     else {
-        if (new_size >= _capacity) reserve(new_size + CAPACITY);
-        for (size_t i = _size; i < new_size; i++) _states[i] = TVectorElemState::empty;
+        if (new_size >= _capacity) grow(new_size + 1);
+        if (_front + new_size > _capacity) move_region(0);
+        value_construct_n(_data + _front + _size, new_size - _size);
+        TVectorStateBits::fill(_states, _front + _size, _front + new_size, TVectorElemState::busy);
     }
     _size = new_size;
 }
 
+// Removes every tombstone now, data() is then the whole vector
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::compact() {
+    cleanup();
+}
+
+// Moves up to 'budget' slots towards the front, returns true once the vector has no tombstones left
+template<class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::compact_step(size_t budget) {
+    if (_deleted == 0) return true;
+    TVECTOR_STAT(_stats.compaction_steps += 1;)
+    if (!_compacting) {
+        _compacting = true;
+        _compact_dst = _front;
+        _compact_src = _front;
+    }
+    size_t end = _front + _size;
+    for (; budget > 0 && _compact_src < end; budget--) {
+        if (_compact_dst == _compact_src) {
+            // Nothing to move until the first tombstone
+            _compact_src = TVectorStateBits::next_not_busy(_states, _compact_src, end);
+            _compact_dst = _compact_src;
+            if (_compact_src == end) break;
+        }
+        if (is_busy(_compact_src)) {
+            if constexpr (is_trivial) {
+                std::memcpy(_data + _compact_dst, _data + _compact_src, sizeof(T));
+            }
+            else {
+                construct_element(_data + _compact_dst, std::move_if_noexcept(_data[_compact_src]));
+                destroy_element(_data + _compact_src);
+            }
+            TVECTOR_STAT(_stats.bytes_moved += sizeof(T);)
+            set_state(_compact_dst, TVectorElemState::busy);
+            set_state(_compact_src, TVectorElemState::deleted);
+            _rank.update(_compact_dst, true);
+            _rank.update(_compact_src, false);
+            _compact_dst++;
+        }
+        _compact_src++;
+    }
+    if (_compact_src == end) finish_compaction();
+    return _is_clean;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> TVectorStats TVector<T, Growth, Allocator, Inline>::stats() const noexcept {
+#if defined(TVECTOR_STATS)
+    return _stats.snapshot();
+#else
+    return TVectorStats();
+#endif
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::reset_stats() noexcept {
+    TVECTOR_STAT(_stats.reset();)
+}
+
+// Serialization functions
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::save(std::ostream& out) const {
+    TVectorStreamWriter<T> writer(out);
+    writer.chunk(size());
+    for_each_busy_run([&](size_t first, size_t count) { writer.elements(_data + first, count); });
+    writer.finish();
+}
+
+// Appends the bytes to 'buffer'
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::save(std::vector<char>& buffer) const {
+    TVectorOutputBuffer sink(buffer);
+    std::ostream out(&sink);
+    save(out);
+}
+
+// Replaces the contents, which stay untouched if the stream is rejected
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::load(std::istream& in) {
+    TVector loaded(_alloc);
+    TVectorStreamReader<T>(in).read_all(loaded);
+    *this = std::move(loaded);
+}
+
+// Returns the number of bytes read from 'data'
+template<class T, class Growth, class Allocator, size_t Inline> size_t TVector<T, Growth, Allocator, Inline>::load(const char* data, size_t size) {
+    TVectorInputBuffer source(data, size);
+    std::istream in(&source);
+    load(in);
+    return source.consumed();
+}
 
 // Operators overload
-template <class T> void TVector<T>::operator=(const TVector<T>& other) {
+template <class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::operator=(const TVector& other) {
     assign(other);
 }
 
-template <class T> TVector<T>& TVector<T>::operator=(TVector&& other) noexcept {
-    if (this != &other) {
-        delete[] _data;
-        delete[] _states;
-
-        _data = std::exchange(other._data, nullptr);
-        _size = std::exchange(other._size, 0);
-        _capacity = std::exchange(other._capacity, CAPACITY);
-        _deleted = std::exchange(other._deleted, 0);
-        _states = std::exchange(other._states, nullptr);
-        _is_clean = std::exchange(other._is_clean, true);
+template <class T, class Growth, class Allocator, size_t Inline> TVector<T, Growth, Allocator, Inline>& TVector<T, Growth, Allocator, Inline>::operator=(TVector&& other)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+    if (this == &other) return *this;
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        release();
+        _alloc = std::move(other._alloc);
+        steal(other);
+    }
+    else if (alloc_traits::is_always_equal::value || _alloc == other._alloc) {
+        release();
+        steal(other);
+    }
+    else {
+        // Buffers of 'other' cannot be freed by this allocator, so the elements are moved one by one
+        TVector moved(TVectorCapacity{ other._capacity }, _alloc);
+        moved._initial_capacity = other._initial_capacity;
+        moved._compaction = other._compaction;
+        other.for_each_busy([&](size_t slot) {
+            moved.construct_at(moved._size, std::move(other._data[slot]));
+            moved._size++;
+        });
+        other.clear();
+        release();
+        steal(moved);
     }
     return *this;
 }
 
-template <class T> bool TVector<T>::operator==(const TVector<T>& other) const {
+template <class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::operator==(const TVector& other) const {
     if (size() != other.size()) return false;
     if (is_empty()) return true;
     for (int i = 0; i < size(); i++) {
@@ -437,130 +1464,661 @@ template <class T> bool TVector<T>::operator==(const TVector<T>& other) const {
     return true;
 }
 
-template <class T> bool TVector<T>::operator!=(const TVector<T>& other) const {
+template <class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::operator!=(const TVector& other) const {
     return !(*this == other);
 }
 
-template <class T> T& TVector<T>::operator[](size_t index) const {
+template <class T, class Growth, class Allocator, size_t Inline> T& TVector<T, Growth, Allocator, Inline>::operator[](size_t index) const {
     return at(index);
 }
 
 // Private functions
-template<class T> void TVector<T>::cleanup() {
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::cleanup() {
     if (_deleted == 0) return;
-    _is_clean = true;
+    TVECTOR_STAT(auto started = std::chrono::steady_clock::now(); size_t moved = 0;)
     size_t new_size = size();
-    size_t index = 0;
-    for (size_t i = 0; i < _size; i++) {
-        if (_states[i] == TVectorElemState::busy) {
-            _data[index] = _data[i];
-            _states[index] = TVectorElemState::busy;
-            index++;
+    size_t index = _front;
+    if constexpr (is_trivial) {
+        for_each_busy_run([&](size_t first, size_t count) {
+            if (first != index) {
+                move_run(_data + index, _data + first, count);
+                TVECTOR_STAT(moved += count;)
+            }
+            index += count;
+        });
+    }
+    else {
+        // A relocation may copy and throw, so the states follow every single
+        // one: the destination becomes busy, the source a tombstone
+        try {
+            for (size_t group = _front / 64; group * 64 < _front + _size; group++) {
+                uint64_t word = TVectorStateBits::busy_word(_states, group);
+                if (word == ~uint64_t(0) && index == group * 64) {
+                    index += 64;
+                    continue;
+                }
+                while (word != 0) {
+                    size_t slot = group * 64 + tvector_ctz(word);
+                    if (slot != index) {
+                        construct_element(_data + index, std::move_if_noexcept(_data[slot]));
+                        set_state(index, TVectorElemState::busy);
+                        set_state(slot, TVectorElemState::deleted);
+                        destroy_element(_data + slot);
+                        TVECTOR_STAT(moved++;)
+                    }
+                    index++;
+                    word &= word - 1;
+                }
+            }
+        }
+        catch (...) {
+            // The vector stays dirty: the tombstones moved to the end of the
+            // live region are dropped and the rank index is rebuilt
+            size_t end = _front + _size;
+            size_t last = TVectorStateBits::prev_busy(_states, end - 1) + 1;
+            TVectorStateBits::fill(_states, last, end, TVectorElemState::empty);
+            _deleted -= end - last;
+            _size = last - _front;
+            _compacting = false;
+            if (_deleted == 0) {
+                mark_clean();
+            }
+            else {
+                _rank.build(_states, _capacity);
+            }
+            throw;
         }
     }
-    for (size_t i = new_size; i < _capacity; i++) _states[i] = TVectorElemState::empty;
+    TVectorStateBits::fill(_states, _front, _front + new_size, TVectorElemState::busy);
+    TVectorStateBits::fill(_states, _front + new_size, _front + _size, TVectorElemState::empty);
     _size = new_size;
     _deleted = 0;
+    mark_clean();
+    TVECTOR_STAT(
+        _stats.cleanups += 1;
+        _stats.bytes_moved += moved * sizeof(T);
+        _stats.cleanup_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
+    )
 }
 
-template<class T> size_t TVector<T>::translate_index(size_t index) const {
+// Incremental mode: starts a compaction pass at DELETED_LIMIT and advances a running one
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::compact_tick() {
+    if (_compaction != TVectorCompaction::incremental || _is_clean) return;
+    if (!_compacting && _deleted < static_cast<size_t>(_size * DELETED_LIMIT)) return;
+    compact_step(COMPACTION_STEP);
+}
+
+// Drops the tombstones left between the compacted part and the end of the live region
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::finish_compaction() noexcept {
+    size_t end = _front + _size;
+    TVectorStateBits::fill(_states, _compact_dst, end, TVectorElemState::empty);
+    _deleted -= end - _compact_dst;
+    _size = _compact_dst - _front;
+    _compacting = false;
+    if (_size == 0) _front = 0;
+    if (_deleted == 0) mark_clean();
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> size_t TVector<T, Growth, Allocator, Inline>::translate_index(size_t index) const {
     if (index < 0 || index >= size()) {
         throw std::out_of_range("TVector: logical index out of range");
     }
 
     if (_is_clean) {
-        return index;
+        return _front + index;
     }
 
-    size_t busy_found = 0;
-    for (size_t i = 0; i < _size; i++) {
-        if (_states[i] == TVectorElemState::busy) {
-            if (busy_found == index) {
-                return i;
-            }
-            busy_found++;
+    TVECTOR_STAT(_stats.translations += 1;)
+    size_t cursor = _rank.cursor_rank();
+    if (cursor != TVectorRankIndex::npos) {
+        size_t slot = _rank.cursor_slot();
+        if (index == cursor) return slot;
+        if (index == cursor + 1) {
+            if (!is_busy(++slot)) slot = TVectorStateBits::next_busy(_states, slot, _front + _size);
+            _rank.move_cursor(index, slot);
+            return slot;
+        }
+        if (index + 1 == cursor) {
+            if (!is_busy(--slot)) slot = TVectorStateBits::prev_busy(_states, slot);
+            _rank.move_cursor(index, slot);
+            return slot;
         }
     }
+
+    size_t rank = 0;
+    size_t block = _rank.select(index, rank);
+    for (size_t group = block * (RANK_BLOCK / 64); group * 64 < _front + _size; group++) {
+        TVECTOR_STAT(_stats.translation_words += 1;)
+        uint64_t word = TVectorStateBits::busy_word(_states, group);
+        size_t count = tvector_popcount(word);
+        if (rank < count) {
+            size_t slot = group * 64 + TVectorStateBits::select(word, rank);
+            _rank.move_cursor(index, slot);
+            return slot;
+        }
+        rank -= count;
+    }
     throw std::logic_error("TVector: internal consistency error");
 }
 
-template<class T> void TVector<T>::swap_elements(size_t begin, size_t end) {
-    for (size_t i = begin; i > end; i--) {
-        _data[i] = _data[i - 1];
-        _states[i] = _states[i - 1];
+// Moves the elements of slots [end, begin) one slot up, slot 'end' is left
+// unconstructed and empty. Slot 'begin' must be free. Non-trivial elements
+// move one slot at a time with their states; if a move throws, the moved ones
+// go back down. Should that throw as well, the gap stays as a tombstone and
+// the live region is extended over slot 'begin'.
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::swap_elements(size_t begin, size_t end) {
+    TVECTOR_STAT(_stats.shifts += 1; _stats.bytes_moved += (begin - end) * sizeof(T);)
+    if constexpr (is_trivial) {
+        if (begin > end) std::memmove(_data + end + 1, _data + end, (begin - end) * sizeof(T));
+        TVectorStateBits::shift_up(_states, end, begin);
+        return;
+    }
+    size_t hole = begin;
+    try {
+        for (; hole > end; hole--) relocate_slot(hole - 1, hole);
+    }
+    catch (...) {
+        try {
+            for (; hole < begin; hole++) relocate_slot(hole + 1, hole);
+        }
+        catch (...) {
+            set_state(hole, TVectorElemState::deleted);
+            _deleted++;
+            _size = begin + 1 - _front;
+            _is_clean = false;
+            _compacting = false;
+            _rank.build(_states, _capacity);
+        }
+        throw;
+    }
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::mark_deleted(size_t index) {
+    set_state(index, TVectorElemState::deleted);
+    _deleted++;
+    TVECTOR_STAT(_stats.tombstone_peak.raise(static_cast<double>(_deleted) / _size);)
+    if (_is_clean) {
+        _is_clean = false;
+        _rank.build(_states, _capacity);
+    }
+    else {
+        _rank.update(index, false);
+    }
+}
 
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::mark_busy(size_t index) {
+    bool was_deleted = (state(index) == TVectorElemState::deleted);
+    set_state(index, TVectorElemState::busy);
+    if (was_deleted) _deleted--;
+    if (_is_clean) return;
+    if (_deleted == 0) {
+        mark_clean();
+    }
+    else {
+        _rank.update(index, true);
     }
 }
 
+template<class T, class Growth, class Allocator, size_t Inline> template<class... Args> void TVector<T, Growth, Allocator, Inline>::construct_at(size_t index, Args&&... args) {
+    construct_element(_data + index, std::forward<Args>(args)...);
+    mark_busy(index);
+}
+
+// Takes over the buffers of 'other', the current ones must already be released.
+// Inline elements cannot change owner, so they are moved into the inline buffer
+// of this vector slot by slot.
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::steal(TVector& other) noexcept {
+    if (other.is_inline()) {
+        _data = inline_data();
+        _states = inline_states();
+        std::memcpy(_states, other._states, TVectorStateBits::words(inline_slots) * sizeof(uint64_t));
+        other.for_each_busy([&](size_t slot) {
+            construct_element(_data + slot, std::move(other._data[slot]));
+            other.destroy_element(other._data + slot);
+        });
+    }
+    else {
+        _data = other._data;
+        _states = other._states;
+    }
+    _capacity = other._capacity;
+    other.reset_buffers();
+    _front = std::exchange(other._front, 0);
+    _size = std::exchange(other._size, 0);
+    _deleted = std::exchange(other._deleted, 0);
+    _initial_capacity = other._initial_capacity;
+    _is_clean = std::exchange(other._is_clean, true);
+    _rank = std::move(other._rank);
+    other._rank.reset();
+    _compaction = other._compaction;
+    _compacting = std::exchange(other._compacting, false);
+    _compact_dst = other._compact_dst;
+    _compact_src = other._compact_src;
+}
+
+// Leaves 'this' empty, on its inline buffer if there is one
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::reset_buffers() noexcept {
+    _data = inline_data();
+    _states = inline_states();
+    _capacity = inline_slots;
+    if (_states != nullptr) std::memset(_states, 0, TVectorStateBits::words(inline_slots) * sizeof(uint64_t));
+}
+
+// A buffer of inline_slots slots is always the inline one
+template<class T, class Growth, class Allocator, size_t Inline> T* TVector<T, Growth, Allocator, Inline>::allocate_data(size_t count) {
+    if (count == 0) return nullptr;
+    if (Inline != 0 && count == inline_slots) return inline_data();
+    T* data = alloc_traits::allocate(_alloc, count);
+    TVECTOR_STAT(_stats.allocations += 1; _stats.bytes_allocated += count * sizeof(T);)
+    return data;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::deallocate_data(T* data, size_t count) noexcept {
+    if (data != nullptr && data != inline_data()) alloc_traits::deallocate(_alloc, data, count);
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> uint64_t* TVector<T, Growth, Allocator, Inline>::allocate_states(size_t capacity) {
+    size_t words = TVectorStateBits::words(capacity);
+    if (words == 0) return nullptr;
+    if (Inline != 0 && capacity == inline_slots) {
+        std::memset(inline_states(), 0, words * sizeof(uint64_t));
+        return inline_states();
+    }
+    state_allocator alloc(_alloc);
+    uint64_t* states = std::allocator_traits<state_allocator>::allocate(alloc, words);
+    TVECTOR_STAT(_stats.allocations += 1; _stats.bytes_allocated += words * sizeof(uint64_t);)
+    std::memset(states, 0, words * sizeof(uint64_t));
+    return states;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::deallocate_states(uint64_t* states, size_t capacity) noexcept {
+    if (states == nullptr || states == inline_states()) return;
+    state_allocator alloc(_alloc);
+    std::allocator_traits<state_allocator>::deallocate(alloc, states, TVectorStateBits::words(capacity));
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::allocate() {
+    if (_capacity < inline_slots) _capacity = inline_slots;
+    _states = allocate_states(_capacity);
+    try {
+        _data = allocate_data(_capacity);
+    }
+    catch (...) {
+        deallocate_states(_states, _capacity);
+        _states = nullptr;
+        throw;
+    }
+}
+
+// Moves the elements of a clean vector into a new buffer of the given capacity, starting at slot 'new_front'
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::reallocate(size_t new_capacity, size_t new_front) {
+    if (Inline != 0 && new_capacity <= inline_slots) {
+        if (is_inline()) {
+            move_region(new_front);
+            return;
+        }
+        new_capacity = inline_slots;
+    }
+    if constexpr (is_trivial && TVectorReallocatable<Allocator>::value) {
+        if (new_capacity > _capacity && _data != nullptr && !is_inline() && reallocate_in_place(new_capacity, new_front)) return;
+    }
+    uint64_t* new_states = allocate_states(new_capacity);
+    T* new_data = nullptr;
+    size_t index = 0;
+    try {
+        new_data = allocate_data(new_capacity);
+        if constexpr (is_trivial) {
+            if (_size != 0) std::memcpy(new_data + new_front, _data + _front, _size * sizeof(T));
+        }
+        else {
+            for (; index < _size; index++) {
+                construct_element(new_data + new_front + index, std::move_if_noexcept(_data[_front + index]));
+            }
+        }
+    }
+    catch (...) {
+        destroy_n(new_data + new_front, index);
+        deallocate_data(new_data, new_capacity);
+        deallocate_states(new_states, new_capacity);
+        throw;
+    }
+    TVECTOR_STAT(_stats.reallocations += 1; _stats.bytes_moved += _size * sizeof(T);)
+    destroy_n(_data + _front, _size);
+    deallocate_data(_data, _capacity);
+    deallocate_states(_states, _capacity);
+    TVectorStateBits::fill(new_states, new_front, new_front + _size, TVectorElemState::busy);
+    _data = new_data;
+    _front = new_front;
+    _states = new_states;
+    _capacity = new_capacity;
+}
+
+// Growth through the allocator's reallocate(), e.g. mremap: the elements stay
+// where they are and only move when the front offset changes
+template<class T, class Growth, class Allocator, size_t Inline> bool TVector<T, Growth, Allocator, Inline>::reallocate_in_place(size_t new_capacity, size_t new_front) {
+    uint64_t* new_states = allocate_states(new_capacity);
+    T* new_data = _alloc.reallocate(_data, _capacity, new_capacity);
+    if (new_data == nullptr) {
+        deallocate_states(new_states, new_capacity);
+        return false;
+    }
+    if (new_front != _front && _size != 0) std::memmove(new_data + new_front, new_data + _front, _size * sizeof(T));
+    TVECTOR_STAT(_stats.reallocations += 1; _stats.bytes_allocated += (new_capacity - _capacity) * sizeof(T);)
+    deallocate_states(_states, _capacity);
+    TVectorStateBits::fill(new_states, new_front, new_front + _size, TVectorElemState::busy);
+    _data = new_data;
+    _front = new_front;
+    _states = new_states;
+    _capacity = new_capacity;
+    return true;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::destroy_elements() noexcept {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for_each_busy([this](size_t slot) { destroy_element(_data + slot); });
+    }
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::release() noexcept {
+    destroy_elements();
+    deallocate_data(_data, _capacity);
+    deallocate_states(_states, _capacity);
+    _data = nullptr;
+    _states = nullptr;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::value_construct_n(T* first, size_t count) {
+    size_t index = 0;
+    try {
+        for (; index < count; index++) construct_element(first + index);
+    }
+    catch (...) {
+        destroy_n(first, index);
+        throw;
+    }
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> template<class Iterator> void TVector<T, Growth, Allocator, Inline>::copy_construct_n(Iterator source, size_t count, T* first) {
+    size_t index = 0;
+    try {
+        for (; index < count; index++, ++source) construct_element(first + index, *source);
+    }
+    catch (...) {
+        destroy_n(first, index);
+        throw;
+    }
+}
+
+// Growing for a push at the front centres the elements in the new buffer so that both ends get spare slots
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::grow(size_t required, bool front) {
+    cleanup();
+    size_t new_capacity = Growth::next_capacity(_capacity, required, _initial_capacity);
+    if (new_capacity > _capacity) reallocate(new_capacity, front ? (new_capacity - _size) / 2 : 0);
+}
+
+// Makes sure that the slot right before (front) or right after the live region is free
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::make_room(bool front) {
+    if (_size + 1 >= _capacity) grow(size() + 1, front);
+    if (front ? _front > 0 : _front + _size < _capacity) return;
+    cleanup();
+    if (front ? _front > 0 : _front + _size < _capacity) return;
+    // Recentring costs O(size), so it is only done while it buys at least size / 4 pushes
+    size_t spare = _capacity - _size;
+    if (spare < _size / 2) {
+        grow(_capacity + 1, front);
+        if (front ? _front > 0 : _front + _size < _capacity) return;
+        spare = _capacity - _size;
+    }
+    move_region(front ? (spare + 1) / 2 : spare / 2);
+}
+
+// Constructs an element at logical index 'index' from arguments that do not
+// refer to elements of the vector
+template<class T, class Growth, class Allocator, size_t Inline> template<class... Args> void TVector<T, Growth, Allocator, Inline>::insert_slot(size_t index, Args&&... args) {
+    if (index > size()) {
+        throw std::out_of_range("TVector.insert: 'index' out of range");
+    }
+    if (index == 0) {
+        emplace_front(std::forward<Args>(args)...);
+        return;
+    }
+    if (index == size()) {
+        emplace_back(std::forward<Args>(args)...);
+        return;
+    }
+    make_room(false);
+    size_t real_index = translate_index(index);
+    swap_elements(_front + _size, real_index);
+    _size++;
+    if (_compacting && real_index <= _compact_dst) {
+        _compact_dst++;
+        _compact_src++;
+    }
+    if (!_is_clean) _rank.build(_states, _capacity);
+    try {
+        construct_at(real_index, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        // The slot stays a tombstone so that the vector remains consistent
+        mark_deleted(real_index);
+        throw;
+    }
+    compact_tick();
+}
+
+// Makes sure that 'count' slots right after the live region are free, keeping
+// the spare slot every push leaves
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::make_room_back(size_t count) {
+    if (_size + count < _capacity && _front + _size + count <= _capacity) return;
+    cleanup();
+    if (_size + count >= _capacity) grow(_size + count + 1);
+    if (_front + _size + count > _capacity) move_region(0);
+}
+
+// Raw room for 'count' elements at the back, filled by the caller and
+// published with commit_back(); only for trivially copyable types
+template<class T, class Growth, class Allocator, size_t Inline> T* TVector<T, Growth, Allocator, Inline>::claim_back(size_t count) {
+    make_room_back(count);
+    return _data + _front + _size;
+}
+
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::commit_back(size_t count) {
+    size_t end = _front + _size;
+    TVectorStateBits::fill(_states, end, end + count, TVectorElemState::busy);
+    _size += count;
+    if (!_is_clean) _rank.build(_states, _capacity);
+}
+
+// Restores the invariants after a batch of slots was marked deleted: the live
+// region starts and ends with a busy slot again, the rank index is rebuilt
+// once and the vector is compacted as a single erase would do it
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::finish_erase() {
+    size_t end = _front + _size;
+    if (_deleted == _size) {
+        TVectorStateBits::fill(_states, _front, end, TVectorElemState::empty);
+        _front = 0;
+        _size = 0;
+        _deleted = 0;
+        mark_clean();
+        return;
+    }
+    size_t first = TVectorStateBits::next_busy(_states, _front, end);
+    size_t last = TVectorStateBits::prev_busy(_states, end - 1) + 1;
+    TVectorStateBits::fill(_states, _front, first, TVectorElemState::empty);
+    TVectorStateBits::fill(_states, last, end, TVectorElemState::empty);
+    _deleted -= (first - _front) + (end - last);
+    _front = first;
+    _size = last - first;
+    if (_compacting) {
+        if (last <= _compact_dst) {
+            _compacting = false;
+        }
+        else if (_front > _compact_dst) {
+            _compact_dst = _front;
+            _compact_src = _front;
+        }
+    }
+    if (_deleted == 0) {
+        mark_clean();
+        return;
+    }
+    _is_clean = false;
+    _rank.build(_states, _capacity);
+    TVECTOR_STAT(_stats.tombstone_peak.raise(static_cast<double>(_deleted) / _size);)
+    if (_compaction == TVectorCompaction::incremental) {
+        compact_tick();
+    }
+    else if (_deleted >= static_cast<size_t>(_size * DELETED_LIMIT)) {
+        cleanup();
+    }
+}
+
+// Moves the live region of a clean vector to start at slot 'new_front'
+template<class T, class Growth, class Allocator, size_t Inline> void TVector<T, Growth, Allocator, Inline>::move_region(size_t new_front) {
+    if (new_front == _front) return;
+    TVECTOR_STAT(_stats.bytes_moved += _size * sizeof(T);)
+    if constexpr (is_trivial) {
+        std::memmove(_data + new_front, _data + _front, _size * sizeof(T));
+    }
+    else if (new_front < _front) {
+        for (size_t i = 0; i < _size; i++) {
+            construct_element(_data + new_front + i, std::move_if_noexcept(_data[_front + i]));
+            destroy_element(_data + _front + i);
+        }
+    }
+    else {
+        for (size_t i = _size; i > 0; i--) {
+            construct_element(_data + new_front + i - 1, std::move_if_noexcept(_data[_front + i - 1]));
+            destroy_element(_data + _front + i - 1);
+        }
+    }
+    TVectorStateBits::fill(_states, _front, _front + _size, TVectorElemState::empty);
+    TVectorStateBits::fill(_states, new_front, new_front + _size, TVectorElemState::busy);
+    _front = new_front;
+}
+
 // Friend functions
 
 // Search functions
-template <class T> int find_first(const TVector<T>& vector, const T& value) {
-    vector.cleanup();
+template <class T, class Growth, class Allocator, size_t Inline> int find_first(const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
     if (vector.is_empty()) {
         throw std::logic_error("find_first: Impossible to find an element - vector is empty");
     }
-    for (int i = 0; i < vector.size(); i++) {
-        if (vector.at(i) == value) return i;
-    }
-    return -1;
+    int result = -1;
+    vector.match_words(value, false, [&](size_t rank, uint64_t busy, uint64_t matches) {
+        uint64_t before = (uint64_t(1) << tvector_ctz(matches)) - 1;
+        result = static_cast<int>(rank + tvector_popcount(busy & before));
+        return false;
+    });
+    return result;
 }
 
-template <class T> int find_last(const TVector<T>& vector, const T& value) {
-    vector.cleanup();
+template <class T, class Growth, class Allocator, size_t Inline> int find_last(const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
     if (vector.is_empty()) {
         throw std::logic_error("find_last: Impossible to find an element - vector is empty");
     }
-    for (int i = vector.size() - 1; i >= 0; i--) {
-        if (vector.at(i) == value) return i;
-    }
-    return -1;
+    int result = -1;
+    vector.match_words(value, true, [&](size_t rank, uint64_t busy, uint64_t matches) {
+        uint64_t before = (uint64_t(1) << (63 - tvector_clz(matches))) - 1;
+        result = static_cast<int>(rank + tvector_popcount(busy & before));
+        return false;
+    });
+    return result;
 }
 
-template <class T> int* find_all(const TVector<T>& vector, const T& value) {
-    vector.cleanup();
+// Returns the indices of all matches in increasing order, empty if there are none
+template <class T, class Growth, class Allocator, size_t Inline> std::vector<int> find_all(const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
     if (vector.is_empty()) {
         throw std::logic_error("find_all: Impossible to find elements - vector is empty");
     }
-    int* result = nullptr, size_res = 0;
-    for (int i = 0; i < vector.size(); i++) {
-        if (vector.at(i) == value) size_res++;
-    }
+    std::vector<int> result;
+    vector.match_words(value, false, [&](size_t rank, uint64_t busy, uint64_t matches) {
+        while (matches != 0) {
+            uint64_t before = (uint64_t(1) << tvector_ctz(matches)) - 1;
+            result.push_back(static_cast<int>(rank + tvector_popcount(busy & before)));
+            matches &= matches - 1;
+        }
+        return true;
+    });
+    return result;
+}
+
+// Shuffling and sampling
 
-    if (size_res == 0) {
-        result = new int[1];
-        result[0] = -1;
+// Fisher-Yates over the compacted storage, with any UniformRandomBitGenerator
+template <class T, class Growth, class Allocator, size_t Inline, class Generator> void vectorShuffle(TVector<T, Growth, Allocator, Inline>& vec, Generator& gen) {
+    if (vec.size() <= 1) return;
+    vec.compact();
+    tvector_shuffle(vec.data(), vec.size(), gen);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline> void vectorShuffle(TVector<T, Growth, Allocator, Inline>& vec) {
+    vectorShuffle(vec, tvector_default_rng());
+}
+
+// k distinct elements in their order in the vector. Small samples draw k
+// indices with Floyd's algorithm, large ones take a selection pass.
+template <class T, class Growth, class Allocator, size_t Inline, class Generator> std::vector<T> vectorSample(const TVector<T, Growth, Allocator, Inline>& vec, size_t k, Generator& gen) {
+    size_t n = vec.size();
+    if (k > n) {
+        throw std::invalid_argument("vectorSample: Invalid argument 'k' - must not exceed the size of the vector");
     }
-    else {
-        result = new int[size_res];
-        for (int i = 0, j = 0; j < size_res; i++) {
-            if (vector.at(i) == value) {
-                result[j] = i;
-                j++;
-            }
+    std::vector<T> result;
+    result.reserve(k);
+    if (k * 16 < n) {
+        std::unordered_set<size_t> chosen;
+        chosen.reserve(k);
+        for (size_t j = n - k; j < n; j++) {
+            size_t t = static_cast<size_t>(tvector_uniform(gen, j + 1));
+            chosen.insert(chosen.count(t) ? j : t);
+        }
+        std::vector<size_t> indexes(chosen.begin(), chosen.end());
+        std::sort(indexes.begin(), indexes.end());
+        for (size_t index : indexes) result.push_back(vec[index]);
+        return result;
+    }
+    size_t needed = k;
+    size_t remaining = n;
+    for (auto it = vec.begin(); needed != 0; ++it, remaining--) {
+        if (tvector_uniform(gen, remaining) < needed) {
+            result.push_back(*it);
+            needed--;
         }
     }
     return result;
 }
 
-// Shuffling
+template <class T, class Growth, class Allocator, size_t Inline> std::vector<T> vectorSample(const TVector<T, Growth, Allocator, Inline>& vec, size_t k) {
+    return vectorSample(vec, k, tvector_default_rng());
+}
+
+// Sorting. The vector is compacted first and its storage sorted in place;
+// arithmetic elements in ascending order go through a radix sort.
 
-template <class T> void vectorShuffle(TVector<T>& vec) {
-    if (vec.size() <= 1) return;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    for (int i = vec.size() - 1; i > 0; i--) {
-        std::uniform_int_distribution<> distr(0, i);
-        int j = distr(gen);
-        std::swap(vec[i], vec[j]);
-    }
+template <class T, class Growth, class Allocator, size_t Inline, class Compare = std::less<>> void vectorSort(TVector<T, Growth, Allocator, Inline>& vec, Compare comp = Compare()) {
+    vec.compact();
+    tvector_sort(vec.data(), vec.size(), comp, false);
 }
 
-template <class T> void vectorShuffle(TVector<T>& vec, std::mt19937& gen) {
-    if (vec.size() <= 1) return;
-    for (int i = vec.size() - 1; i > 0; i--) {
-        std::uniform_int_distribution<> distr(0, i);
-        int j = distr(gen);
-        std::swap(vec[i], vec[j]);
+template <class T, class Growth, class Allocator, size_t Inline, class Compare = std::less<>> void vectorStableSort(TVector<T, Growth, Allocator, Inline>& vec, Compare comp = Compare()) {
+    vec.compact();
+    tvector_sort(vec.data(), vec.size(), comp, true);
+}
+
+// Puts the 'count' smallest elements in order at the front, the rest in no particular order
+template <class T, class Growth, class Allocator, size_t Inline, class Compare = std::less<>> void vectorPartialSort(TVector<T, Growth, Allocator, Inline>& vec, size_t count, Compare comp = Compare()) {
+    if (count > vec.size()) {
+        throw std::invalid_argument("vectorPartialSort: Invalid argument 'count' - must not exceed the size of the vector");
     }
+    vec.compact();
+    std::partial_sort(vec.data(), vec.data() + count, vec.data() + vec.size(), comp);
 }
+
+// Polymorphic allocator alias
+namespace pmr {
+    template<class T, class Growth = TGeometricGrowth<>> using TVector = ::TVector<T, Growth, std::pmr::polymorphic_allocator<T>>;
+}
+
+// Vector that keeps up to N elements inside the object
+template<class T, size_t N, class Growth = TGeometricGrowth<>, class Allocator = std::allocator<T>>
+using TSmallVector = TVector<T, Growth, Allocator, N>;
@@ -0,0 +1,119 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#pragma once
+#include "TVector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define TVECTOR_HUGE_PAGES 1
+#endif
+
+#define HUGE_PAGE_SIZE (size_t(2) << 20) // transparent huge page on x86-64 and most arm64 kernels
+#define HUGE_PAGE_THRESHOLD (size_t(8) << 20) // smaller buffers stay on the heap
+
+// Allocator for large vectors scanned by the SIMD kernels. Buffers are
+// aligned to 'Alignment' bytes (a cache line by default), so no vector load
+// of an aligned scan is split. On POSIX systems buffers of at least
+// 'Threshold' bytes are mapped directly, aligned to HUGE_PAGE_SIZE and on
+// Linux marked with MADV_HUGEPAGE, which cuts the TLB misses of long scans.
+// Such buffers also grow in place with mremap: TVector uses reallocate() for
+// trivially copyable elements, so growth does not copy the elements.
+// Threshold == 0 turns the mapped path off.
+template<class T, size_t Alignment = 64, size_t Threshold = HUGE_PAGE_THRESHOLD> class TVectorAlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "TVectorAlignedAllocator: the alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "TVectorAlignedAllocator: the alignment must not be below alignof(T)");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    template<class U> struct rebind {
+        using other = TVectorAlignedAllocator<U, (Alignment < alignof(U)) ? alignof(U) : Alignment, Threshold>;
+    };
+
+    TVectorAlignedAllocator() noexcept = default;
+    template<class U, size_t A> TVectorAlignedAllocator(const TVectorAlignedAllocator<U, A, Threshold>&) noexcept {}
+
+    T* allocate(size_t);
+    void deallocate(T*, size_t) noexcept;
+    // Resizes a mapped buffer keeping its bytes, possibly at a new address.
+    // Returns nullptr when it is not possible; the buffer is then untouched.
+    T* reallocate(T*, size_t, size_t) noexcept;
+
+    template<class U, size_t A> inline bool operator==(const TVectorAlignedAllocator<U, A, Threshold>&) const noexcept { return true; };
+    template<class U, size_t A> inline bool operator!=(const TVectorAlignedAllocator<U, A, Threshold>&) const noexcept { return false; };
+
+    static inline bool is_mapped(size_t count) noexcept {
+#if defined(TVECTOR_HUGE_PAGES)
+        return Threshold != 0 && count >= Threshold / sizeof(T);
+#else
+        (void)count;
+        return false;
+#endif
+    };
+
+private:
+    static inline size_t mapped_bytes(size_t count) noexcept {
+        return (count * sizeof(T) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    };
+};
+
+// Vector whose data buffer is aligned to 'Alignment' bytes
+template<class T, size_t Alignment = 64, class Growth = TGeometricGrowth<>>
+using TAlignedVector = TVector<T, Growth, TVectorAlignedAllocator<T, Alignment>>;
+
+template<class T, size_t Alignment, size_t Threshold> T* TVectorAlignedAllocator<T, Alignment, Threshold>::allocate(size_t count) {
+    if (count > (std::numeric_limits<size_t>::max() - 2 * HUGE_PAGE_SIZE) / sizeof(T)) throw std::bad_array_new_length();
+#if defined(TVECTOR_HUGE_PAGES)
+    if (is_mapped(count)) {
+        // One huge page more than needed, the unaligned head and the tail are unmapped again
+        size_t bytes = mapped_bytes(count);
+        void* mapping = ::mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+        uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~uintptr_t(HUGE_PAGE_SIZE - 1);
+        if (aligned != start) ::munmap(mapping, aligned - start);
+        if (aligned - start != HUGE_PAGE_SIZE) ::munmap(reinterpret_cast<void*>(aligned + bytes), HUGE_PAGE_SIZE - (aligned - start));
+#if defined(MADV_HUGEPAGE)
+        ::madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<T*>(aligned);
+    }
+#endif
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+}
+
+template<class T, size_t Alignment, size_t Threshold> void TVectorAlignedAllocator<T, Alignment, Threshold>::deallocate(T* data, size_t count) noexcept {
+#if defined(TVECTOR_HUGE_PAGES)
+    if (is_mapped(count)) {
+        ::munmap(data, mapped_bytes(count));
+        return;
+    }
+#endif
+    ::operator delete(data, std::align_val_t(Alignment));
+}
+
+// The kernel moves the page table entries, not the bytes. A moved buffer
+// keeps page alignment, which covers every Alignment up to the page size.
+template<class T, size_t Alignment, size_t Threshold> T* TVectorAlignedAllocator<T, Alignment, Threshold>::reallocate(T* data, size_t count, size_t new_count) noexcept {
+#if defined(TVECTOR_HUGE_PAGES) && defined(__linux__)
+    if (!is_mapped(count) || !is_mapped(new_count) || Alignment > 4096) return nullptr;
+    if (new_count > (std::numeric_limits<size_t>::max() - 2 * HUGE_PAGE_SIZE) / sizeof(T)) return nullptr;
+    void* address = ::mremap(data, mapped_bytes(count), mapped_bytes(new_count), MREMAP_MAYMOVE);
+    if (address == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+    ::madvise(address, mapped_bytes(new_count), MADV_HUGEPAGE);
+#endif
+    return static_cast<T*>(address);
+#else
+    (void)data;
+    (void)count;
+    (void)new_count;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,522 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#pragma once
+#include "TVector.h"
+
+#define PARALLEL_GRAIN 32768 // minimal slots per chunk, smaller ranges are not worth a thread
+#define PARALLEL_CHUNKS 4 // chunks per thread, evens out ranges with many tombstones
+#define PARALLEL_SHUFFLE_BLOCKS 64 // most blocks of a parallel shuffle, each one costs a merge pass
+
+// Fixed set of threads running one batch of indexed tasks at a time. The
+// calling thread takes part in the batch, so a pool of N threads starts
+// N - 1 workers. A batch started from inside a task runs inline.
+class TVectorThreadPool {
+    std::vector<std::thread> _workers;
+    std::mutex _batch; // held by the thread running a batch
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    void (*_invoke)(void*, size_t);
+    void* _context;
+    size_t _tasks;
+    std::atomic<size_t> _next;
+    size_t _generation;
+    size_t _active;
+    std::exception_ptr _error;
+    bool _stop;
+
+public:
+    // 0 threads means one per hardware thread
+    explicit TVectorThreadPool(size_t threads = 0);
+    TVectorThreadPool(const TVectorThreadPool&) = delete;
+    TVectorThreadPool& operator=(const TVectorThreadPool&) = delete;
+    ~TVectorThreadPool() { stop(); }
+
+    inline size_t concurrency() const noexcept { return _workers.size() + 1; };
+
+    // Calls function(i) for every i in [0, tasks) and returns once all calls
+    // have finished. The first exception thrown by a task is rethrown here,
+    // tasks that have not started by then are skipped.
+    template<class Function> void run(size_t tasks, Function&& function);
+
+    // Pool with one thread per hardware thread, created on first use
+    static TVectorThreadPool& shared();
+
+private:
+    void work() noexcept;
+    void worker_loop() noexcept;
+    void stop() noexcept;
+    static inline bool& inside_task() noexcept {
+        thread_local bool flag = false;
+        return flag;
+    };
+};
+
+inline TVectorThreadPool::TVectorThreadPool(size_t threads) :
+    _invoke(nullptr),
+    _context(nullptr),
+    _tasks(0),
+    _next(0),
+    _generation(0),
+    _active(0),
+    _stop(false)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    try {
+        _workers.reserve(threads - 1);
+        for (size_t i = 1; i < threads; i++) _workers.emplace_back([this] { worker_loop(); });
+    }
+    catch (...) {
+        stop();
+        throw;
+    }
+}
+
+inline TVectorThreadPool& TVectorThreadPool::shared() {
+    static TVectorThreadPool pool;
+    return pool;
+}
+
+template<class Function> void TVectorThreadPool::run(size_t tasks, Function&& function) {
+    if (tasks == 0) return;
+    if (tasks == 1 || _workers.empty() || inside_task()) {
+        for (size_t i = 0; i < tasks; i++) function(i);
+        return;
+    }
+    using Callable = std::remove_reference_t<Function>;
+    std::lock_guard<std::mutex> batch(_batch);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _invoke = [](void* context, size_t index) { (*static_cast<Callable*>(context))(index); };
+        _context = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+        _tasks = tasks;
+        _next.store(0, std::memory_order_relaxed);
+        _active = _workers.size();
+        _generation++;
+    }
+    _wake.notify_all();
+    work();
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _active == 0; });
+        std::swap(error, _error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+inline void TVectorThreadPool::work() noexcept {
+    inside_task() = true;
+    for (size_t index = _next.fetch_add(1); index < _tasks; index = _next.fetch_add(1)) {
+        try {
+            _invoke(_context, index);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error) _error = std::current_exception();
+            _next.store(_tasks);
+        }
+    }
+    inside_task() = false;
+}
+
+// Every worker takes part in every batch, the batch ends when all of them are back
+inline void TVectorThreadPool::worker_loop() noexcept {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _wake.wait(lock, [&] { return _stop || _generation != seen; });
+        if (_stop) return;
+        seen = _generation;
+        lock.unlock();
+        work();
+        lock.lock();
+        if (--_active == 0) _done.notify_one();
+    }
+}
+
+inline void TVectorThreadPool::stop() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) worker.join();
+    _workers.clear();
+}
+
+// Execution policy of the parallel algorithms: the pool to run on (the shared
+// one when null) and the minimal number of slots per chunk
+struct TVectorParallelPolicy {
+    TVectorThreadPool* pool;
+    size_t grain;
+
+    constexpr TVectorParallelPolicy on(TVectorThreadPool& target) const noexcept { return { &target, grain }; };
+    constexpr TVectorParallelPolicy with_grain(size_t slots) const noexcept { return { pool, slots }; };
+};
+
+inline constexpr TVectorParallelPolicy tvector_par{ nullptr, PARALLEL_GRAIN };
+
+// The algorithms split the slots of the live region into chunks of whole state
+// words, so every task reads its own words of the bitmap and skips the
+// tombstones of its chunk. Logical indices are rebuilt from the number of busy
+// slots in the chunks before.
+class TVectorParallel {
+    struct Chunks {
+        size_t first_group;
+        size_t end_group;
+        size_t step; // state words per chunk
+        size_t count;
+
+        inline size_t begin(size_t chunk) const noexcept { return first_group + chunk * step; };
+        inline size_t end(size_t chunk) const noexcept {
+            return (begin(chunk) + step < end_group) ? begin(chunk) + step : end_group;
+        };
+    };
+
+    static inline TVectorThreadPool& pool_of(const TVectorParallelPolicy& policy) {
+        return (policy.pool != nullptr) ? *policy.pool : TVectorThreadPool::shared();
+    };
+
+    template<class T, class G, class A, size_t I> static Chunks split(const TVector<T, G, A, I>& vector, const TVectorParallelPolicy& policy, const TVectorThreadPool& pool) noexcept {
+        Chunks chunks;
+        chunks.first_group = vector._front / 64;
+        chunks.end_group = (vector._front + vector._size + 63) / 64;
+        size_t groups = chunks.end_group - chunks.first_group;
+        size_t wanted = pool.concurrency() * PARALLEL_CHUNKS;
+        chunks.step = (policy.grain < 64) ? 1 : policy.grain / 64;
+        if ((groups + chunks.step - 1) / chunks.step > wanted) chunks.step = (groups + wanted - 1) / wanted;
+        chunks.count = (groups + chunks.step - 1) / chunks.step;
+        return chunks;
+    };
+
+    // Number of busy slots in a chunk
+    template<class T, class G, class A, size_t I> static size_t busy_in(const TVector<T, G, A, I>& vector, const Chunks& chunks, size_t chunk) noexcept {
+        size_t from = chunks.begin(chunk) * 64;
+        size_t to = chunks.end(chunk) * 64;
+        if (vector._is_clean) {
+            size_t first = (from > vector._front) ? from : vector._front;
+            size_t last = (to < vector._front + vector._size) ? to : vector._front + vector._size;
+            return last - first;
+        }
+        size_t result = 0;
+        for (size_t group = chunks.begin(chunk); group < chunks.end(chunk); group++) {
+            result += tvector_popcount(TVectorStateBits::busy_word(vector._states, group));
+        }
+        return result;
+    };
+
+    // Logical index of the first busy slot of every chunk
+    template<class T, class G, class A, size_t I> static std::vector<size_t> ranks(const TVector<T, G, A, I>& vector, const Chunks& chunks, TVectorThreadPool& pool) {
+        std::vector<size_t> result(chunks.count);
+        if (vector._is_clean) {
+            for (size_t chunk = 0; chunk < chunks.count; chunk++) result[chunk] = busy_in(vector, chunks, chunk);
+        }
+        else {
+            pool.run(chunks.count, [&](size_t chunk) { result[chunk] = busy_in(vector, chunks, chunk); });
+        }
+        size_t rank = 0;
+        for (size_t chunk = 0; chunk < chunks.count; chunk++) {
+            size_t count = result[chunk];
+            result[chunk] = rank;
+            rank += count;
+        }
+        return result;
+    };
+
+public:
+    template<class T, class G, class A, size_t I> static int find_first(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, const T& value) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        if (chunks.count <= 1) return ::find_first(vector, value);
+        std::vector<size_t> counts(chunks.count);
+        std::vector<size_t> found(chunks.count);
+        std::atomic<size_t> best(chunks.count);
+        pool.run(chunks.count, [&](size_t chunk) {
+            if (best.load(std::memory_order_relaxed) < chunk) return;
+            bool hit = false;
+            vector.match_words(value, chunks.begin(chunk), chunks.end(chunk), 0, false, [&](size_t rank, uint64_t busy, uint64_t matches) {
+                uint64_t before = (uint64_t(1) << tvector_ctz(matches)) - 1;
+                found[chunk] = rank + tvector_popcount(busy & before);
+                hit = true;
+                return false;
+            });
+            if (!hit) {
+                counts[chunk] = busy_in(vector, chunks, chunk);
+                return;
+            }
+            size_t current = best.load(std::memory_order_relaxed);
+            while (chunk < current && !best.compare_exchange_weak(current, chunk)) {}
+        });
+        // Every chunk before the best one was searched to its end
+        size_t chunk = best.load();
+        if (chunk == chunks.count) return -1;
+        size_t rank = found[chunk];
+        for (size_t i = 0; i < chunk; i++) rank += counts[i];
+        return static_cast<int>(rank);
+    };
+
+    template<class T, class G, class A, size_t I> static int find_last(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, const T& value) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        if (chunks.count <= 1) return ::find_last(vector, value);
+        std::vector<size_t> counts(chunks.count);
+        std::vector<size_t> found(chunks.count);
+        std::atomic<size_t> best(0); // one past the best chunk
+        pool.run(chunks.count, [&](size_t chunk) {
+            counts[chunk] = busy_in(vector, chunks, chunk);
+            if (best.load(std::memory_order_relaxed) > chunk) return;
+            bool hit = false;
+            vector.match_words(value, chunks.begin(chunk), chunks.end(chunk), counts[chunk], true, [&](size_t rank, uint64_t busy, uint64_t matches) {
+                uint64_t before = (uint64_t(1) << (63 - tvector_clz(matches))) - 1;
+                found[chunk] = rank + tvector_popcount(busy & before);
+                hit = true;
+                return false;
+            });
+            if (!hit) return;
+            size_t current = best.load(std::memory_order_relaxed);
+            while (chunk + 1 > current && !best.compare_exchange_weak(current, chunk + 1)) {}
+        });
+        size_t chunk = best.load();
+        if (chunk == 0) return -1;
+        chunk--;
+        size_t rank = found[chunk];
+        for (size_t i = 0; i < chunk; i++) rank += counts[i];
+        return static_cast<int>(rank);
+    };
+
+    // Chunks collect their hits separately, the merge keeps them in increasing order
+    template<class T, class G, class A, size_t I> static std::vector<int> find_all(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, const T& value) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        if (chunks.count <= 1) return ::find_all(vector, value);
+        std::vector<size_t> counts(chunks.count);
+        std::vector<std::vector<int>> hits(chunks.count);
+        pool.run(chunks.count, [&](size_t chunk) {
+            vector.match_words(value, chunks.begin(chunk), chunks.end(chunk), 0, false, [&](size_t rank, uint64_t busy, uint64_t matches) {
+                while (matches != 0) {
+                    uint64_t before = (uint64_t(1) << tvector_ctz(matches)) - 1;
+                    hits[chunk].push_back(static_cast<int>(rank + tvector_popcount(busy & before)));
+                    matches &= matches - 1;
+                }
+                return true;
+            });
+            counts[chunk] = busy_in(vector, chunks, chunk);
+        });
+        std::vector<size_t> offsets(chunks.count);
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < chunks.count; chunk++) {
+            offsets[chunk] = total;
+            total += hits[chunk].size();
+        }
+        std::vector<int> result(total);
+        pool.run(chunks.count, [&](size_t chunk) {
+            size_t rank = 0;
+            for (size_t i = 0; i < chunk; i++) rank += counts[i];
+            for (size_t i = 0; i < hits[chunk].size(); i++) {
+                result[offsets[chunk] + i] = hits[chunk][i] + static_cast<int>(rank);
+            }
+        });
+        return result;
+    };
+
+    template<class T, class G, class A, size_t I> static size_t count(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, const T& value) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        std::vector<size_t> counts(chunks.count);
+        pool.run(chunks.count, [&](size_t chunk) {
+            vector.match_words(value, chunks.begin(chunk), chunks.end(chunk), 0, false, [&](size_t, uint64_t, uint64_t matches) {
+                counts[chunk] += tvector_popcount(matches);
+                return true;
+            });
+        });
+        size_t result = 0;
+        for (size_t chunk = 0; chunk < chunks.count; chunk++) result += counts[chunk];
+        return result;
+    };
+
+    template<class T, class G, class A, size_t I, class Predicate> static size_t count_if(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, Predicate predicate) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        std::vector<size_t> counts(chunks.count);
+        pool.run(chunks.count, [&](size_t chunk) {
+            size_t result = 0;
+            vector.for_each_busy_run(chunks.begin(chunk), chunks.end(chunk), [&](size_t first, size_t count) {
+                const T* data = vector._data + first;
+                for (size_t i = 0; i < count; i++) result += predicate(data[i]) ? 1 : 0;
+            });
+            counts[chunk] = result;
+        });
+        size_t result = 0;
+        for (size_t chunk = 0; chunk < chunks.count; chunk++) result += counts[chunk];
+        return result;
+    };
+
+    template<class T, class G, class A, size_t I, class Function> static void for_each(const TVectorParallelPolicy& policy, TVector<T, G, A, I>& vector, Function function) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        pool.run(chunks.count, [&](size_t chunk) {
+            vector.for_each_busy_run(chunks.begin(chunk), chunks.end(chunk), [&](size_t first, size_t count) {
+                T* data = vector._data + first;
+                for (size_t i = 0; i < count; i++) function(data[i]);
+            });
+        });
+    };
+
+    // Writes function(vector[i]) to output[i], 'output' is a random access iterator
+    template<class T, class G, class A, size_t I, class Output, class Function> static void transform(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, Output output, Function function) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        std::vector<size_t> first_ranks = ranks(vector, chunks, pool);
+        pool.run(chunks.count, [&](size_t chunk) {
+            Output target = output + static_cast<std::ptrdiff_t>(first_ranks[chunk]);
+            vector.for_each_busy_run(chunks.begin(chunk), chunks.end(chunk), [&](size_t first, size_t count) {
+                const T* data = vector._data + first;
+                for (size_t i = 0; i < count; i++, ++target) *target = function(data[i]);
+            });
+        });
+    };
+
+    // Partial results of the chunks are combined in order, so 'operation' has
+    // to be associative; unlike std::reduce it does not have to be commutative
+    template<class T, class G, class A, size_t I, class R, class Operation> static R reduce(const TVectorParallelPolicy& policy, const TVector<T, G, A, I>& vector, R init, Operation operation) {
+        TVectorThreadPool& pool = pool_of(policy);
+        Chunks chunks = split(vector, policy, pool);
+        std::vector<std::optional<R>> partial(chunks.count);
+        pool.run(chunks.count, [&](size_t chunk) {
+            std::optional<R>& result = partial[chunk];
+            vector.for_each_busy_run(chunks.begin(chunk), chunks.end(chunk), [&](size_t first, size_t count) {
+                const T* data = vector._data + first;
+                size_t i = 0;
+                if (!result) result.emplace(data[i++]);
+                R accumulator = std::move(*result);
+                for (; i < count; i++) accumulator = operation(std::move(accumulator), data[i]);
+                *result = std::move(accumulator);
+            });
+        });
+        for (size_t chunk = 0; chunk < chunks.count; chunk++) {
+            if (partial[chunk]) init = operation(std::move(init), std::move(*partial[chunk]));
+        }
+        return init;
+    };
+
+    // The blocks (a power of two, at least one per thread) are sorted in
+    // parallel, then merged pairwise in log2(blocks) rounds
+    template<class T, class G, class A, size_t I, class Compare> static void sort(const TVectorParallelPolicy& policy, TVector<T, G, A, I>& vector, Compare comp, bool stable) {
+        size_t n = vector.size();
+        vector.compact();
+        T* data = vector.data();
+        TVectorThreadPool& pool = pool_of(policy);
+        size_t grain = (policy.grain == 0) ? 1 : policy.grain;
+        size_t blocks = 1;
+        while (blocks < pool.concurrency() && n / (blocks * 2) >= grain) blocks *= 2;
+        auto bound = [n, blocks](size_t block) { return n / blocks * block + n % blocks * block / blocks; };
+        pool.run(blocks, [&](size_t block) {
+            tvector_sort(data + bound(block), bound(block + 1) - bound(block), comp, stable);
+        });
+        for (size_t width = 1; width < blocks; width *= 2) {
+            pool.run(blocks / (width * 2), [&](size_t pair) {
+                T* first = data + bound(pair * width * 2);
+                std::inplace_merge(first, data + bound(pair * width * 2 + width), data + bound((pair + 1) * width * 2), comp);
+            });
+        }
+    };
+
+    // MergeShuffle: the blocks are shuffled in parallel, then merged pairwise
+    // in log2(blocks) rounds. The blocks depend on the size and the grain,
+    // not on the pool, and every block and merge has its own generator
+    // stream, so a seed gives the same permutation on any number of threads.
+    template<class T, class G, class A, size_t I> static void shuffle(const TVectorParallelPolicy& policy, TVector<T, G, A, I>& vector, uint64_t seed) {
+        size_t n = vector.size();
+        if (n <= 1) return;
+        vector.compact();
+        T* data = vector.data();
+        size_t grain = (policy.grain == 0) ? 1 : policy.grain;
+        size_t blocks = 1;
+        while (blocks < PARALLEL_SHUFFLE_BLOCKS && n / (blocks * 2) >= grain) blocks *= 2;
+        auto bound = [n, blocks](size_t block) { return n / blocks * block + n % blocks * block / blocks; };
+        TVectorThreadPool& pool = pool_of(policy);
+        pool.run(blocks, [&](size_t block) {
+            TVectorRng rng = TVectorRng::stream(seed, block);
+            tvector_shuffle(data + bound(block), bound(block + 1) - bound(block), rng);
+        });
+        for (size_t width = 1, round = 1; width < blocks; width *= 2, round++) {
+            pool.run(blocks / (width * 2), [&](size_t pair) {
+                size_t first = bound(pair * width * 2);
+                TVectorRng rng = TVectorRng::stream(seed, round * blocks + pair);
+                tvector_merge_shuffle(data + first, bound(pair * width * 2 + width) - first, bound((pair + 1) * width * 2) - first, rng);
+            });
+        }
+    };
+};
+
+// Parallel overloads, the policy comes first as with std::execution:
+//     find_first(tvector_par, vector, value);
+//     reduce(tvector_par.on(pool), vector, 0L);
+
+template <class T, class Growth, class Allocator, size_t Inline> int find_first(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
+    return TVectorParallel::find_first(policy, vector, value);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline> int find_last(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
+    return TVectorParallel::find_last(policy, vector, value);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline> std::vector<int> find_all(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
+    return TVectorParallel::find_all(policy, vector, value);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline> size_t count(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, const T& value) {
+    return TVectorParallel::count(policy, vector, value);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class Predicate> size_t count_if(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, Predicate predicate) {
+    return TVectorParallel::count_if(policy, vector, predicate);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class Function> void for_each(const TVectorParallelPolicy& policy, TVector<T, Growth, Allocator, Inline>& vector, Function function) {
+    TVectorParallel::for_each(policy, vector, function);
+}
+
+// In place: every element is replaced by function(element)
+template <class T, class Growth, class Allocator, size_t Inline, class Function> void transform(const TVectorParallelPolicy& policy, TVector<T, Growth, Allocator, Inline>& vector, Function function) {
+    TVectorParallel::for_each(policy, vector, [&](T& element) { element = function(element); });
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class Output, class Function> void transform(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, Output output, Function function) {
+    TVectorParallel::transform(policy, vector, output, function);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class R, class Operation> R reduce(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, R init, Operation operation) {
+    return TVectorParallel::reduce(policy, vector, std::move(init), operation);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class R> R reduce(const TVectorParallelPolicy& policy, const TVector<T, Growth, Allocator, Inline>& vector, R init) {
+    return TVectorParallel::reduce(policy, vector, std::move(init), std::plus<>());
+}
+
+// Reproducible for a given seed, whatever the size of the pool
+template <class T, class Growth, class Allocator, size_t Inline> void vectorShuffle(const TVectorParallelPolicy& policy, TVector<T, Growth, Allocator, Inline>& vector, uint64_t seed) {
+    TVectorParallel::shuffle(policy, vector, seed);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class Compare = std::less<>> void vectorSort(const TVectorParallelPolicy& policy, TVector<T, Growth, Allocator, Inline>& vector, Compare comp = Compare()) {
+    TVectorParallel::sort(policy, vector, comp, false);
+}
+
+template <class T, class Growth, class Allocator, size_t Inline, class Compare = std::less<>> void vectorStableSort(const TVectorParallelPolicy& policy, TVector<T, Growth, Allocator, Inline>& vector, Compare comp = Compare()) {
+    TVectorParallel::sort(policy, vector, comp, true);
+}
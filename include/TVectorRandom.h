@@ -0,0 +1,169 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#pragma once
+
+// Random engine of the shuffling and sampling functions
+
+inline uint64_t tvector_splitmix(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator, a UniformRandomBitGenerator. The state is expanded
+// from a 64-bit seed with splitmix64, stream(seed, i) gives the independent
+// generators of the parallel algorithms.
+class TVectorRng {
+    uint64_t _state[4];
+
+    static inline uint64_t rotl(uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); };
+
+public:
+    using result_type = uint64_t;
+
+    explicit TVectorRng(uint64_t seed = 0) noexcept {
+        for (uint64_t& word : _state) word = tvector_splitmix(seed);
+    }
+    static inline TVectorRng stream(uint64_t seed, uint64_t index) noexcept {
+        uint64_t mixed = index;
+        return TVectorRng(seed ^ tvector_splitmix(mixed));
+    };
+
+    static constexpr result_type min() noexcept { return 0; };
+    static constexpr result_type max() noexcept { return ~uint64_t(0); };
+
+    inline result_type operator()() noexcept {
+        uint64_t result = rotl(_state[1] * 5, 7) * 9;
+        uint64_t t = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+        return result;
+    };
+};
+
+// Generator of the calls without one, seeded once per thread
+inline TVectorRng& tvector_default_rng() {
+    thread_local TVectorRng rng((uint64_t(std::random_device()()) << 32) ^ std::random_device()());
+    return rng;
+}
+
+template<class Generator> constexpr bool tvector_full_range() noexcept {
+    return Generator::min() == 0 && Generator::max() == ~uint64_t(0);
+}
+
+// Uniform in [0, bound). 64-bit generators use Lemire's multiply-shift
+// method, which rarely needs a division; others go through the standard
+// distribution.
+template<class Generator> inline uint64_t tvector_uniform(Generator& gen, uint64_t bound) {
+    if constexpr (tvector_full_range<Generator>()) {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(gen()) * bound;
+        uint64_t low = static_cast<uint64_t>(product);
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<unsigned __int128>(gen()) * bound;
+                low = static_cast<uint64_t>(product);
+            }
+        }
+        return static_cast<uint64_t>(product >> 64);
+#else
+        uint64_t threshold = (0 - bound) % bound;
+        uint64_t value = gen();
+        while (value < threshold) value = gen();
+        return value % bound;
+#endif
+    }
+    else {
+        return std::uniform_int_distribution<uint64_t>(0, bound - 1)(gen);
+    }
+}
+
+// Uniform in (0, 1]
+template<class Generator> inline double tvector_unit(Generator& gen) {
+    if constexpr (tvector_full_range<Generator>()) {
+        return static_cast<double>((gen() >> 11) + 1) * 0x1.0p-53;
+    }
+    else {
+        return 1.0 - std::generate_canonical<double, 53>(gen);
+    }
+}
+
+// Fisher-Yates over 'count' contiguous elements
+template<class T, class Generator> void tvector_shuffle(T* data, size_t count, Generator& gen) {
+    using std::swap;
+    for (size_t i = count; i > 1; i--) {
+        size_t j = static_cast<size_t>(tvector_uniform(gen, i));
+        if (j != i - 1) swap(data[i - 1], data[j]);
+    }
+}
+
+// MergeShuffle merge of two shuffled blocks [0, middle) and [middle, count):
+// a coin picks the block of every position until one runs out, the rest
+// is placed by Fisher-Yates insertion. The result is a uniform shuffle.
+template<class T, class Generator> void tvector_merge_shuffle(T* data, size_t middle, size_t count, Generator& gen) {
+    using std::swap;
+    size_t i = 0;
+    size_t j = middle;
+    uint64_t coins = 0;
+    size_t left = 0;
+    while (true) {
+        if (left == 0) {
+            coins = tvector_full_range<Generator>() ? static_cast<uint64_t>(gen()) : tvector_uniform(gen, ~uint64_t(0));
+            left = 64;
+        }
+        bool second = coins & 1;
+        coins >>= 1;
+        left--;
+        if (second) {
+            if (j == count) break;
+            swap(data[i], data[j++]);
+        }
+        else if (i == j) {
+            break;
+        }
+        i++;
+    }
+    for (; i < count; i++) {
+        size_t k = static_cast<size_t>(tvector_uniform(gen, i + 1));
+        if (k != i) swap(data[i], data[k]);
+    }
+}
+
+// Reservoir sample of k elements of a range of unknown length, Li's
+// algorithm L: the gaps between replacements are drawn directly, so only
+// O(k log(n / k)) random numbers are used. The order of the result is random.
+template<class Iterator, class Generator> std::vector<typename std::iterator_traits<Iterator>::value_type> vectorReservoirSample(Iterator first, Iterator last, size_t k, Generator& gen) {
+    std::vector<typename std::iterator_traits<Iterator>::value_type> reservoir;
+    if (k == 0) return reservoir;
+    reservoir.reserve(k);
+    for (; first != last && reservoir.size() < k; ++first) reservoir.push_back(*first);
+    double w = std::exp(std::log(tvector_unit(gen)) / static_cast<double>(k));
+    while (first != last) {
+        double gap = std::floor(std::log(tvector_unit(gen)) / std::log1p(-w));
+        if constexpr (std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value) {
+            if (gap >= static_cast<double>(last - first)) break;
+            first += static_cast<typename std::iterator_traits<Iterator>::difference_type>(gap);
+        }
+        else {
+            for (; gap > 0 && first != last; gap--) ++first;
+        }
+        if (first == last) break;
+        reservoir[static_cast<size_t>(tvector_uniform(gen, k))] = *first;
+        ++first;
+        w *= std::exp(std::log(tvector_unit(gen)) / static_cast<double>(k));
+    }
+    return reservoir;
+}
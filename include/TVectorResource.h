@@ -0,0 +1,204 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#pragma once
+#include "TVector.h"
+
+#define ARENA_CHUNK 4096
+#define POOL_MIN_BLOCK 16
+#define POOL_MAX_BLOCK 65536
+#define POOL_SLAB 65536
+
+// Memory resources for pmr::TVector. Neither of them is thread-safe.
+
+// Monotonic arena: allocations are carved from chunks that grow geometrically,
+// memory is only returned by reset() or release(). Freeing the most recent
+// allocation rolls the arena back, which covers temporaries such as copies.
+class TVectorArena : public std::pmr::memory_resource {
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    std::pmr::memory_resource* _upstream;
+    Chunk* _chunks;
+    char* _cursor;
+    char* _end;
+    size_t _next_chunk;
+    size_t _initial_chunk;
+
+public:
+    explicit TVectorArena(size_t initial_chunk = ARENA_CHUNK,
+                          std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) :
+        _upstream(upstream),
+        _chunks(nullptr),
+        _cursor(nullptr),
+        _end(nullptr),
+        _next_chunk(initial_chunk < sizeof(Chunk) * 2 ? sizeof(Chunk) * 2 : initial_chunk),
+        _initial_chunk(_next_chunk)
+    {}
+    TVectorArena(const TVectorArena&) = delete;
+    TVectorArena& operator=(const TVectorArena&) = delete;
+    ~TVectorArena() override { release(); }
+
+    // Frees every chunk
+    void release() noexcept;
+    // Makes all memory available again but keeps the newest (largest) chunk,
+    // so an arena reused across requests stops calling the upstream resource
+    void reset() noexcept;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+    void add_chunk(size_t bytes, size_t alignment);
+};
+
+inline void TVectorArena::release() noexcept {
+    while (_chunks != nullptr) {
+        Chunk* next = _chunks->next;
+        _upstream->deallocate(_chunks, _chunks->size, alignof(std::max_align_t));
+        _chunks = next;
+    }
+    _cursor = nullptr;
+    _end = nullptr;
+    _next_chunk = _initial_chunk;
+}
+
+inline void TVectorArena::reset() noexcept {
+    if (_chunks == nullptr) return;
+    while (_chunks->next != nullptr) {
+        Chunk* next = _chunks->next;
+        _chunks->next = next->next;
+        _upstream->deallocate(next, next->size, alignof(std::max_align_t));
+    }
+    _cursor = reinterpret_cast<char*>(_chunks + 1);
+    _end = reinterpret_cast<char*>(_chunks) + _chunks->size;
+}
+
+inline void* TVectorArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t address = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    if (_cursor == nullptr || address + bytes > reinterpret_cast<uintptr_t>(_end)) {
+        add_chunk(bytes, alignment);
+        address = (reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+    _cursor = reinterpret_cast<char*>(address + bytes);
+    return reinterpret_cast<void*>(address);
+}
+
+inline void TVectorArena::do_deallocate(void* pointer, size_t bytes, size_t) {
+    if (static_cast<char*>(pointer) + bytes == _cursor) _cursor = static_cast<char*>(pointer);
+}
+
+// Chunks double like the default growth policy, so a growing vector needs O(log n) of them
+inline void TVectorArena::add_chunk(size_t bytes, size_t alignment) {
+    size_t required = sizeof(Chunk) + bytes + alignment;
+    while (_next_chunk < required) _next_chunk *= 2;
+    Chunk* chunk = static_cast<Chunk*>(_upstream->allocate(_next_chunk, alignof(std::max_align_t)));
+    chunk->next = _chunks;
+    chunk->size = _next_chunk;
+    _chunks = chunk;
+    _cursor = reinterpret_cast<char*>(chunk + 1);
+    _end = reinterpret_cast<char*>(chunk) + chunk->size;
+    _next_chunk *= 2;
+}
+
+// Pool of fixed-size blocks with one free list per power-of-two size class,
+// blocks are never returned to the upstream resource before release().
+// The default capacity of 15 doubled by TGeometricGrowth gives buffers of
+// 15 * 2^k elements, which fill their class almost completely; the state
+// bitmap of a small vector takes a single 16 byte block.
+class TVectorPool : public std::pmr::memory_resource {
+    static constexpr size_t classes = 13; // POOL_MIN_BLOCK << 12 == POOL_MAX_BLOCK
+
+    struct Block {
+        Block* next;
+    };
+    struct Slab {
+        Slab* next;
+        size_t size;
+    };
+
+    std::pmr::memory_resource* _upstream;
+    Block* _free[classes];
+    Slab* _slabs;
+
+public:
+    explicit TVectorPool(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) :
+        _upstream(upstream),
+        _free(),
+        _slabs(nullptr)
+    {}
+    TVectorPool(const TVectorPool&) = delete;
+    TVectorPool& operator=(const TVectorPool&) = delete;
+    ~TVectorPool() override { release(); }
+
+    // Frees every slab, blocks handed out before become invalid
+    void release() noexcept;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+    static inline size_t size_class(size_t bytes) noexcept {
+        if (bytes <= POOL_MIN_BLOCK) return 0;
+        return 64 - tvector_clz(static_cast<uint64_t>(bytes - 1)) - 4;
+    }
+    void refill(size_t index);
+};
+
+inline void TVectorPool::release() noexcept {
+    while (_slabs != nullptr) {
+        Slab* next = _slabs->next;
+        _upstream->deallocate(_slabs, _slabs->size, alignof(std::max_align_t));
+        _slabs = next;
+    }
+    for (size_t i = 0; i < classes; i++) _free[i] = nullptr;
+}
+
+inline void* TVectorPool::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > POOL_MAX_BLOCK || alignment > alignof(std::max_align_t)) {
+        return _upstream->allocate(bytes, alignment);
+    }
+    size_t index = size_class(bytes);
+    if (_free[index] == nullptr) refill(index);
+    Block* block = _free[index];
+    _free[index] = block->next;
+    return block;
+}
+
+inline void TVectorPool::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    if (bytes > POOL_MAX_BLOCK || alignment > alignof(std::max_align_t)) {
+        _upstream->deallocate(pointer, bytes, alignment);
+        return;
+    }
+    size_t index = size_class(bytes);
+    Block* block = static_cast<Block*>(pointer);
+    block->next = _free[index];
+    _free[index] = block;
+}
+
+// Cuts a new slab into blocks of the given class, the large classes get at
+// least two blocks per slab. Blocks follow a header padded to max_align_t.
+inline void TVectorPool::refill(size_t index) {
+    const size_t header = (sizeof(Slab) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    size_t block_size = size_t(POOL_MIN_BLOCK) << index;
+    size_t count = (POOL_SLAB - header) / block_size;
+    if (count < 2) count = 2;
+    size_t slab_size = header + count * block_size;
+    char* memory = static_cast<char*>(_upstream->allocate(slab_size, alignof(std::max_align_t)));
+    Slab* slab = reinterpret_cast<Slab*>(memory);
+    slab->next = _slabs;
+    slab->size = slab_size;
+    _slabs = slab;
+    for (size_t i = count; i > 0; i--) {
+        Block* block = reinterpret_cast<Block*>(memory + header + (i - 1) * block_size);
+        block->next = _free[index];
+        _free[index] = block;
+    }
+}
@@ -0,0 +1,233 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+#pragma once
+
+// Binary format of TVector::save(): a 16-byte header (magic "TVEC", byte
+// order mark, version, element size) followed by chunks, each a uint64
+// element count and the elements. A zero count ends the stream. Fields are
+// in the byte order of the writer, a reader with another one rejects them.
+#define SERIAL_MAGIC 0x43455654u // "TVEC"
+#define SERIAL_ORDER 0x01020304u
+#define SERIAL_VERSION 1u
+#define SERIAL_BLOCK (1u << 20) // bytes read per reservation of a bulk chunk
+
+// Element hook of the format. Trivially copyable types are written as raw
+// bytes in bulk; other types need a specialization with 'bulk' set to false
+// and static write(std::ostream&, const T&) / T read(std::istream&).
+template<class T, class Enable = void> struct TVectorSerializer {
+    static_assert(std::is_trivially_copyable<T>::value, "TVectorSerializer: specialize it for element types that are not trivially copyable");
+    static constexpr bool bulk = true;
+};
+
+template<class Char, class Traits, class Allocator> struct TVectorSerializer<std::basic_string<Char, Traits, Allocator>> {
+    using value_type = std::basic_string<Char, Traits, Allocator>;
+    static constexpr bool bulk = false;
+
+    static void write(std::ostream& out, const value_type& value) {
+        uint64_t length = value.size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(reinterpret_cast<const char*>(value.data()), static_cast<std::streamsize>(value.size() * sizeof(Char)));
+    };
+    static value_type read(std::istream& in) {
+        uint64_t length = 0;
+        if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            throw std::runtime_error("TVectorSerializer: truncated string");
+        }
+        value_type value;
+        // Grown piece by piece, a corrupt length fails on the data instead of the allocation
+        while (value.size() < length) {
+            size_t piece = std::min<uint64_t>(length - value.size(), SERIAL_BLOCK / sizeof(Char));
+            size_t done = value.size();
+            value.resize(done + piece);
+            if (!in.read(reinterpret_cast<char*>(&value[done]), static_cast<std::streamsize>(piece * sizeof(Char)))) {
+                throw std::runtime_error("TVectorSerializer: truncated string");
+            }
+        }
+        return value;
+    };
+};
+
+// Output stream buffer appending to a byte vector
+class TVectorOutputBuffer : public std::streambuf {
+    std::vector<char>& _buffer;
+
+public:
+    explicit TVectorOutputBuffer(std::vector<char>& buffer) : _buffer(buffer) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) _buffer.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    };
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        _buffer.insert(_buffer.end(), data, data + count);
+        return count;
+    };
+};
+
+// Input stream buffer reading a byte range in place
+class TVectorInputBuffer : public std::streambuf {
+public:
+    TVectorInputBuffer(const char* data, size_t size) {
+        char* first = const_cast<char*>(data);
+        setg(first, first, first + size);
+    }
+    inline size_t consumed() const noexcept { return static_cast<size_t>(gptr() - eback()); };
+};
+
+// Writes the format chunk by chunk. A chunk announced with chunk(count) is
+// filled by any number of elements() calls, so runs split by tombstones can
+// share one count.
+template<class T> class TVectorStreamWriter {
+    using serializer = TVectorSerializer<T>;
+
+    std::ostream& _out;
+    size_t _pending;
+    bool _finished;
+
+public:
+    explicit TVectorStreamWriter(std::ostream&);
+    TVectorStreamWriter(const TVectorStreamWriter&) = delete;
+    TVectorStreamWriter& operator=(const TVectorStreamWriter&) = delete;
+
+    void chunk(size_t);
+    void elements(const T*, size_t);
+    inline void write(const T* data, size_t count) {
+        if (count == 0) return;
+        chunk(count);
+        elements(data, count);
+    };
+    // Writes the end mark, the writer takes no more chunks
+    void finish();
+
+private:
+    inline void put(uint64_t value) { _out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    inline void check() const {
+        if (!_out) throw std::runtime_error("TVectorStreamWriter: write failed");
+    };
+};
+
+template<class T> TVectorStreamWriter<T>::TVectorStreamWriter(std::ostream& out) : _out(out), _pending(0), _finished(false) {
+    uint32_t header[4] = { SERIAL_MAGIC, SERIAL_ORDER, SERIAL_VERSION, serializer::bulk ? static_cast<uint32_t>(sizeof(T)) : 0u };
+    _out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    check();
+}
+
+template<class T> void TVectorStreamWriter<T>::chunk(size_t count) {
+    if (_finished || _pending != 0) {
+        throw std::logic_error("TVectorStreamWriter.chunk: the previous chunk is not complete or the stream is finished");
+    }
+    if (count == 0) return;
+    put(count);
+    _pending = count;
+    check();
+}
+
+template<class T> void TVectorStreamWriter<T>::elements(const T* data, size_t count) {
+    if (count > _pending) {
+        throw std::logic_error("TVectorStreamWriter.elements: more elements than the chunk announced");
+    }
+    if constexpr (serializer::bulk) {
+        _out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+    }
+    else {
+        for (size_t i = 0; i < count; i++) serializer::write(_out, data[i]);
+    }
+    _pending -= count;
+    check();
+}
+
+template<class T> void TVectorStreamWriter<T>::finish() {
+    if (_finished) return;
+    if (_pending != 0) {
+        throw std::logic_error("TVectorStreamWriter.finish: the last chunk is not complete");
+    }
+    put(0);
+    _finished = true;
+    check();
+}
+
+// Reads the format one chunk at a time and appends it to a vector, so the
+// total size need not be known up front. Room is reserved per block of the
+// chunk; bulk elements are read straight into the free slots.
+template<class T> class TVectorStreamReader {
+    using serializer = TVectorSerializer<T>;
+
+    std::istream& _in;
+    bool _done;
+
+public:
+    // Reads and checks the header
+    explicit TVectorStreamReader(std::istream&);
+    TVectorStreamReader(const TVectorStreamReader&) = delete;
+    TVectorStreamReader& operator=(const TVectorStreamReader&) = delete;
+
+    inline bool is_done() const noexcept { return _done; };
+    // Appends the next chunk, false once the end mark is read
+    template<class Vector> bool read_chunk(Vector&);
+    // Appends the remaining chunks and returns the number of elements read
+    template<class Vector> size_t read_all(Vector&);
+
+private:
+    inline void get(void* value, size_t bytes) {
+        if (!_in.read(static_cast<char*>(value), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("TVectorStreamReader: truncated stream");
+        }
+    };
+};
+
+template<class T> TVectorStreamReader<T>::TVectorStreamReader(std::istream& in) : _in(in), _done(false) {
+    uint32_t header[4];
+    get(header, sizeof(header));
+    if (header[0] != SERIAL_MAGIC) {
+        throw std::runtime_error("TVectorStreamReader: not a TVector stream");
+    }
+    if (header[1] != SERIAL_ORDER) {
+        throw std::runtime_error("TVectorStreamReader: the stream was written with another byte order");
+    }
+    if (header[2] != SERIAL_VERSION) {
+        throw std::runtime_error("TVectorStreamReader: unsupported format version");
+    }
+    if (header[3] != (serializer::bulk ? sizeof(T) : 0u)) {
+        throw std::runtime_error("TVectorStreamReader: the stream holds another element type");
+    }
+}
+
+template<class T> template<class Vector> bool TVectorStreamReader<T>::read_chunk(Vector& vec) {
+    if (_done) return false;
+    uint64_t count = 0;
+    get(&count, sizeof(count));
+    if (count == 0) {
+        _done = true;
+        return false;
+    }
+    const size_t block = std::max<size_t>(1, SERIAL_BLOCK / sizeof(T));
+    while (count != 0) {
+        size_t piece = static_cast<size_t>(std::min<uint64_t>(count, block));
+        if constexpr (serializer::bulk) {
+            get(vec.claim_back(piece), piece * sizeof(T));
+            vec.commit_back(piece);
+        }
+        else {
+            vec.claim_back(piece);
+            for (size_t i = 0; i < piece; i++) vec.emplace_back(serializer::read(_in));
+        }
+        count -= piece;
+    }
+    return true;
+}
+
+template<class T> template<class Vector> size_t TVectorStreamReader<T>::read_all(Vector& vec) {
+    size_t before = vec.size();
+    while (read_chunk(vec)) {}
+    return vec.size() - before;
+}
@@ -0,0 +1,169 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TVECTOR_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TVECTOR_AVX2 1
+#define TVECTOR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Equality kernels for the search functions. A kernel compares up to 64
+// consecutive elements with a value and returns the matches as a bit mask,
+// bit i standing for data[i].
+
+enum class TVectorSimdLevel { scalar, sse2, avx2 };
+
+// Element types the vector kernels handle: plain integers and float/double
+template<class T> struct TVectorSimdSupported : std::integral_constant<bool,
+    (std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+    std::is_same<T, float>::value || std::is_same<T, double>::value> {};
+
+template<class T> inline uint64_t tvector_match_scalar(const T* data, size_t count, const T& value) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (data[i] == value) mask |= uint64_t(1) << i;
+    }
+    return mask;
+}
+
+template<class T> inline uint64_t tvector_match_plain(const T* data, size_t count, T value) {
+    return tvector_match_scalar(data, count, value);
+}
+
+#if defined(TVECTOR_X86)
+template<class T> inline uint64_t tvector_match_sse2(const T* data, size_t count, T value) {
+    constexpr size_t lanes = 16 / sizeof(T);
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        uint64_t bits;
+        if constexpr (std::is_same<T, float>::value) {
+            bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data + i), _mm_set1_ps(value))));
+        }
+        else if constexpr (std::is_same<T, double>::value) {
+            bits = static_cast<uint64_t>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data + i), _mm_set1_pd(value))));
+        }
+        else {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            if constexpr (sizeof(T) == 1) {
+                __m128i equal = _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(value)));
+                bits = static_cast<uint32_t>(_mm_movemask_epi8(equal));
+            }
+            else if constexpr (sizeof(T) == 2) {
+                __m128i equal = _mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(value)));
+                bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(equal, _mm_setzero_si128())));
+            }
+            else if constexpr (sizeof(T) == 4) {
+                __m128i equal = _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(value)));
+                bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+            }
+            else {
+                // No 64-bit compare in SSE2: both 32-bit halves have to match
+                __m128i equal = _mm_cmpeq_epi32(block, _mm_set1_epi64x(static_cast<long long>(value)));
+                equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+                bits = static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(equal)));
+            }
+        }
+        mask |= bits << i;
+    }
+    if (i < count) mask |= tvector_match_scalar(data + i, count - i, value) << i;
+    return mask;
+}
+#endif
+
+#if defined(TVECTOR_AVX2)
+template<class T> TVECTOR_TARGET_AVX2 inline uint64_t tvector_match_avx2(const T* data, size_t count, T value) {
+    constexpr size_t lanes = 32 / sizeof(T);
+    uint64_t mask = 0;
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        uint64_t bits;
+        if constexpr (std::is_same<T, float>::value) {
+            __m256 equal = _mm256_cmp_ps(_mm256_loadu_ps(data + i), _mm256_set1_ps(value), _CMP_EQ_OQ);
+            bits = static_cast<uint64_t>(_mm256_movemask_ps(equal));
+        }
+        else if constexpr (std::is_same<T, double>::value) {
+            __m256d equal = _mm256_cmp_pd(_mm256_loadu_pd(data + i), _mm256_set1_pd(value), _CMP_EQ_OQ);
+            bits = static_cast<uint64_t>(_mm256_movemask_pd(equal));
+        }
+        else {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            if constexpr (sizeof(T) == 1) {
+                __m256i equal = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast<char>(value)));
+                bits = static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+            }
+            else if constexpr (sizeof(T) == 2) {
+                // Packing works per 128-bit lane, the permute puts both halves in the low lane
+                __m256i equal = _mm256_cmpeq_epi16(block, _mm256_set1_epi16(static_cast<short>(value)));
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(equal, _mm256_setzero_si256()), 0xD8);
+                bits = static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xFFFF;
+            }
+            else if constexpr (sizeof(T) == 4) {
+                __m256i equal = _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(value)));
+                bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+            }
+            else {
+                __m256i equal = _mm256_cmpeq_epi64(block, _mm256_set1_epi64x(static_cast<long long>(value)));
+                bits = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(equal)));
+            }
+        }
+        mask |= bits << i;
+    }
+    if (i < count) mask |= tvector_match_scalar(data + i, count - i, value) << i;
+    return mask;
+}
+#endif
+
+inline TVectorSimdLevel tvector_detect_simd_level() noexcept {
+#if defined(TVECTOR_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return TVectorSimdLevel::avx2;
+    return TVectorSimdLevel::sse2;
+#elif defined(TVECTOR_X86)
+    return TVectorSimdLevel::sse2;
+#else
+    return TVectorSimdLevel::scalar;
+#endif
+}
+
+// Level used by the kernels, detected once. It can be lowered (not raised)
+// with tvector_set_simd_level(), e.g. to compare the kernels. It is atomic
+// because the parallel searches read it from their worker threads.
+inline std::atomic<TVectorSimdLevel>& tvector_simd_level_ref() noexcept {
+    static std::atomic<TVectorSimdLevel> level(tvector_detect_simd_level());
+    return level;
+}
+
+inline TVectorSimdLevel tvector_simd_level() noexcept {
+    return tvector_simd_level_ref().load(std::memory_order_relaxed);
+}
+
+inline void tvector_set_simd_level(TVectorSimdLevel level) noexcept {
+    TVectorSimdLevel detected = tvector_detect_simd_level();
+    tvector_simd_level_ref().store((static_cast<int>(level) < static_cast<int>(detected)) ? level : detected, std::memory_order_relaxed);
+}
+
+template<class T> using TVectorMatcher = uint64_t (*)(const T*, size_t, T);
+
+template<class T> inline TVectorMatcher<T> tvector_matcher() noexcept {
+    static_assert(TVectorSimdSupported<T>::value, "tvector_matcher: element type has no vector kernel");
+    switch (tvector_simd_level()) {
+#if defined(TVECTOR_AVX2)
+    case TVectorSimdLevel::avx2:
+        return &tvector_match_avx2<T>;
+#endif
+#if defined(TVECTOR_X86)
+    case TVectorSimdLevel::sse2:
+        return &tvector_match_sse2<T>;
+#endif
+    default:
+        return &tvector_match_plain<T>;
+    }
+}
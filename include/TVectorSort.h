@@ -0,0 +1,88 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#pragma once
+
+#define SORT_RADIX_MIN 256 // smaller ranges are left to the comparison sorts
+
+// Sorting kernels over contiguous storage, used by vectorSort() and friends
+
+// Arithmetic keys in ascending order are sorted by radix, other comparators
+// and types by comparison
+template<class T, class Compare> struct TVectorRadixSortable : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) &&
+    (std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value)> {};
+
+template<size_t Size> struct TVectorRadixWord;
+template<> struct TVectorRadixWord<1> { using type = uint8_t; };
+template<> struct TVectorRadixWord<2> { using type = uint16_t; };
+template<> struct TVectorRadixWord<4> { using type = uint32_t; };
+template<> struct TVectorRadixWord<8> { using type = uint64_t; };
+
+// Unsigned key with the order of the value: the sign bit is flipped for
+// signed integers, negative floats are inverted. -0.0 is keyed as +0.0 so
+// that equal values stay in order.
+template<class T> inline typename TVectorRadixWord<sizeof(T)>::type tvector_radix_key(T value) noexcept {
+    using word = typename TVectorRadixWord<sizeof(T)>::type;
+    constexpr word top = word(word(1) << (sizeof(T) * 8 - 1));
+    if constexpr (std::is_floating_point<T>::value) {
+        value = value + T(0);
+        word bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return (bits & top) ? word(~bits) : word(bits | top);
+    }
+    else if constexpr (std::is_signed<T>::value) {
+        return word(word(value) ^ top);
+    }
+    else {
+        return word(value);
+    }
+}
+
+// LSD radix sort by bytes, stable. Passes where every key has the same byte
+// are skipped, so narrow value ranges cost fewer passes.
+template<class T> void tvector_radix_sort(T* data, size_t count, T* buffer) {
+    constexpr size_t passes = sizeof(T);
+    size_t counts[passes][256] = {};
+    for (size_t i = 0; i < count; i++) {
+        auto key = tvector_radix_key(data[i]);
+        for (size_t pass = 0; pass < passes; pass++) counts[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+    T* from = data;
+    T* to = buffer;
+    auto first_key = tvector_radix_key(data[0]);
+    for (size_t pass = 0; pass < passes; pass++) {
+        size_t* bucket = counts[pass];
+        if (bucket[(first_key >> (pass * 8)) & 0xFF] == count) continue;
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; b++) {
+            size_t size = bucket[b];
+            bucket[b] = offset;
+            offset += size;
+        }
+        for (size_t i = 0; i < count; i++) {
+            to[bucket[(tvector_radix_key(from[i]) >> (pass * 8)) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != data) std::memcpy(data, from, count * sizeof(T));
+}
+
+template<class T, class Compare> void tvector_sort(T* data, size_t count, Compare comp, bool stable) {
+    if (count <= 1) return;
+    if constexpr (TVectorRadixSortable<T, Compare>::value) {
+        if (count >= SORT_RADIX_MIN) {
+            std::unique_ptr<T[]> buffer(new T[count]);
+            tvector_radix_sort(data, count, buffer.get());
+            return;
+        }
+    }
+    if (stable) std::stable_sort(data, data + count, comp);
+    else std::sort(data, data + count, comp);
+}
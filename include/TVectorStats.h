@@ -0,0 +1,215 @@
+// "Copyright 2025 Artem Denisov 3824B1PR2"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#pragma once
+
+// Hot-path statistics, compiled in only with TVECTOR_STATS defined. Without
+// it TVECTOR_STAT() drops its argument, the vectors carry no counters and
+// stats() returns zeros.
+#if defined(TVECTOR_STATS)
+#define TVECTOR_STAT(...) __VA_ARGS__
+#else
+#define TVECTOR_STAT(...)
+#endif
+
+// Snapshot of the counters of one vector or of the registry
+struct TVectorStats {
+    size_t allocations = 0; // data and state buffers taken from the allocator
+    size_t bytes_allocated = 0;
+    size_t reallocations = 0;
+    size_t bytes_moved = 0; // element bytes moved by reallocations, compactions and shifts
+    size_t cleanups = 0; // full compactions
+    uint64_t cleanup_ns = 0;
+    size_t compaction_steps = 0; // incremental compaction calls
+    size_t translations = 0; // dirty-path logical to physical translations
+    size_t translation_words = 0; // state words they scanned
+    size_t shifts = 0; // tail shifts of a middle insert
+    double tombstone_peak = 0; // highest ratio of tombstones to slots in the live region
+
+    TVectorStats& operator+=(const TVectorStats& other) noexcept;
+};
+
+inline TVectorStats& TVectorStats::operator+=(const TVectorStats& other) noexcept {
+    allocations += other.allocations;
+    bytes_allocated += other.bytes_allocated;
+    reallocations += other.reallocations;
+    bytes_moved += other.bytes_moved;
+    cleanups += other.cleanups;
+    cleanup_ns += other.cleanup_ns;
+    compaction_steps += other.compaction_steps;
+    translations += other.translations;
+    translation_words += other.translation_words;
+    shifts += other.shifts;
+    if (other.tombstone_peak > tombstone_peak) tombstone_peak = other.tombstone_peak;
+    return *this;
+}
+
+// Counter owned by one vector. Only that vector writes it, so an increment is
+// a relaxed load and store, but the registry may read it from another thread.
+template<class V> class TVectorCounter {
+    std::atomic<V> _value;
+
+public:
+    TVectorCounter() noexcept : _value(0) {}
+    inline V get() const noexcept { return _value.load(std::memory_order_relaxed); };
+    inline void set(V value) noexcept { _value.store(value, std::memory_order_relaxed); };
+    inline TVectorCounter& operator+=(V delta) noexcept {
+        set(get() + delta);
+        return *this;
+    };
+    inline void raise(V value) noexcept {
+        if (value > get()) set(value);
+    };
+};
+
+class TVectorStatsBlock;
+
+// Global list of the vectors whose counters are scraped, off by default.
+// Vectors created while it is enabled attach to it; the counters of the
+// destroyed ones are folded into a retired total.
+class TVectorStatsRegistry {
+    mutable std::mutex _mutex;
+    std::vector<const TVectorStatsBlock*> _live;
+    TVectorStats _retired;
+    std::atomic<bool> _enabled;
+
+public:
+    TVectorStatsRegistry() : _enabled(false) {}
+    TVectorStatsRegistry(const TVectorStatsRegistry&) = delete;
+    TVectorStatsRegistry& operator=(const TVectorStatsRegistry&) = delete;
+
+    static TVectorStatsRegistry& instance();
+
+    inline bool enabled() const noexcept { return _enabled.load(std::memory_order_relaxed); };
+    inline void set_enabled(bool value) noexcept { _enabled.store(value, std::memory_order_relaxed); };
+
+    size_t live() const;
+    // Sum over the live and the destroyed vectors
+    TVectorStats total() const;
+    // One "tvector_<counter> <value>" line per counter
+    void write(std::ostream&) const;
+    // Forgets the retired total, live vectors keep their counters
+    void reset();
+
+    void attach(const TVectorStatsBlock*);
+    void detach(const TVectorStatsBlock*);
+};
+
+// Counters of one vector. Copies start from zero: they are new vectors.
+class TVectorStatsBlock {
+    bool _registered;
+
+public:
+    TVectorCounter<size_t> allocations;
+    TVectorCounter<size_t> bytes_allocated;
+    TVectorCounter<size_t> reallocations;
+    TVectorCounter<size_t> bytes_moved;
+    TVectorCounter<size_t> cleanups;
+    TVectorCounter<uint64_t> cleanup_ns;
+    TVectorCounter<size_t> compaction_steps;
+    TVectorCounter<size_t> translations;
+    TVectorCounter<size_t> translation_words;
+    TVectorCounter<size_t> shifts;
+    TVectorCounter<double> tombstone_peak;
+
+    TVectorStatsBlock() : _registered(TVectorStatsRegistry::instance().enabled()) {
+        if (_registered) TVectorStatsRegistry::instance().attach(this);
+    }
+    TVectorStatsBlock(const TVectorStatsBlock&) : TVectorStatsBlock() {}
+    TVectorStatsBlock& operator=(const TVectorStatsBlock&) noexcept { return *this; }
+    ~TVectorStatsBlock() {
+        if (_registered) TVectorStatsRegistry::instance().detach(this);
+    }
+
+    TVectorStats snapshot() const noexcept;
+    void reset() noexcept;
+};
+
+inline TVectorStats TVectorStatsBlock::snapshot() const noexcept {
+    TVectorStats result;
+    result.allocations = allocations.get();
+    result.bytes_allocated = bytes_allocated.get();
+    result.reallocations = reallocations.get();
+    result.bytes_moved = bytes_moved.get();
+    result.cleanups = cleanups.get();
+    result.cleanup_ns = cleanup_ns.get();
+    result.compaction_steps = compaction_steps.get();
+    result.translations = translations.get();
+    result.translation_words = translation_words.get();
+    result.shifts = shifts.get();
+    result.tombstone_peak = tombstone_peak.get();
+    return result;
+}
+
+inline void TVectorStatsBlock::reset() noexcept {
+    allocations.set(0);
+    bytes_allocated.set(0);
+    reallocations.set(0);
+    bytes_moved.set(0);
+    cleanups.set(0);
+    cleanup_ns.set(0);
+    compaction_steps.set(0);
+    translations.set(0);
+    translation_words.set(0);
+    shifts.set(0);
+    tombstone_peak.set(0);
+}
+
+inline TVectorStatsRegistry& TVectorStatsRegistry::instance() {
+    static TVectorStatsRegistry registry;
+    return registry;
+}
+
+inline size_t TVectorStatsRegistry::live() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _live.size();
+}
+
+inline TVectorStats TVectorStatsRegistry::total() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    TVectorStats result = _retired;
+    for (const TVectorStatsBlock* block : _live) result += block->snapshot();
+    return result;
+}
+
+inline void TVectorStatsRegistry::write(std::ostream& out) const {
+    TVectorStats stats = total();
+    out << "tvector_live " << live() << '\n'
+        << "tvector_allocations " << stats.allocations << '\n'
+        << "tvector_bytes_allocated " << stats.bytes_allocated << '\n'
+        << "tvector_reallocations " << stats.reallocations << '\n'
+        << "tvector_bytes_moved " << stats.bytes_moved << '\n'
+        << "tvector_cleanups " << stats.cleanups << '\n'
+        << "tvector_cleanup_ns " << stats.cleanup_ns << '\n'
+        << "tvector_compaction_steps " << stats.compaction_steps << '\n'
+        << "tvector_translations " << stats.translations << '\n'
+        << "tvector_translation_words " << stats.translation_words << '\n'
+        << "tvector_shifts " << stats.shifts << '\n'
+        << "tvector_tombstone_peak " << stats.tombstone_peak << '\n';
+}
+
+inline void TVectorStatsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _retired = TVectorStats();
+}
+
+inline void TVectorStatsRegistry::attach(const TVectorStatsBlock* block) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _live.push_back(block);
+}
+
+// Swap-and-pop: the order of the live list does not matter
+inline void TVectorStatsRegistry::detach(const TVectorStatsBlock* block) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < _live.size(); i++) {
+        if (_live[i] != block) continue;
+        _retired += block->snapshot();
+        _live[i] = _live.back();
+        _live.pop_back();
+        return;
+    }
+}
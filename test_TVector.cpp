@@ -1,6 +1,111 @@
 #include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <deque>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <iterator>
+#include <cstdio>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
 
-#include "../lib_TVector/TVector.h"
+// The tests run with the statistics compiled in
+#ifndef TVECTOR_STATS
+#define TVECTOR_STATS
+#endif
+#include "TVector.h"
+#include "TVectorResource.h"
+#include "TVectorParallel.h"
+#include "TMappedVector.h"
+#include "TCowVector.h"
+#include "TConcurrentVector.h"
+#include "TSegmentedVector.h"
+#include "TStaticVector.h"
+#include "TVectorAllocator.h"
+
+struct Counted {
+    static int alive;
+    int value;
+    Counted() : value(0) { alive++; }
+    explicit Counted(int v) : value(v) { alive++; }
+    Counted(const Counted& other) : value(other.value) { alive++; }
+    Counted(Counted&& other) noexcept : value(other.value) { alive++; }
+    Counted& operator=(const Counted&) = default;
+    ~Counted() { alive--; }
+    bool operator==(const Counted& other) const { return value == other.value; }
+    bool operator!=(const Counted& other) const { return value != other.value; }
+};
+int Counted::alive = 0;
+
+// Stateful allocator counting the live allocations of every type it is rebound to
+struct AllocationLog {
+    int live = 0;
+    int state_allocations = 0;
+};
+
+template<class T> struct LoggingAllocator {
+    using value_type = T;
+    AllocationLog* log;
+    explicit LoggingAllocator(AllocationLog* l) : log(l) {}
+    template<class U> LoggingAllocator(const LoggingAllocator<U>& other) : log(other.log) {}
+    T* allocate(size_t count) {
+        log->live++;
+        if (std::is_same<T, uint64_t>::value) log->state_allocations++;
+        return std::allocator<T>().allocate(count);
+    }
+    void deallocate(T* pointer, size_t count) {
+        log->live--;
+        std::allocator<T>().deallocate(pointer, count);
+    }
+    template<class U> bool operator==(const LoggingAllocator<U>& other) const { return log == other.log; }
+    template<class U> bool operator!=(const LoggingAllocator<U>& other) const { return log != other.log; }
+};
+
+// Thread-safe allocator counting its allocate() calls
+std::atomic<int> shared_allocations(0);
+
+template<class T> struct SharedCountingAllocator {
+    using value_type = T;
+    SharedCountingAllocator() = default;
+    template<class U> SharedCountingAllocator(const SharedCountingAllocator<U>&) {}
+    T* allocate(size_t count) {
+        shared_allocations++;
+        return std::allocator<T>().allocate(count);
+    }
+    void deallocate(T* pointer, size_t count) { std::allocator<T>().deallocate(pointer, count); }
+    template<class U> bool operator==(const SharedCountingAllocator<U>&) const { return true; }
+    template<class U> bool operator!=(const SharedCountingAllocator<U>&) const { return false; }
+};
+
+struct NoDefault {
+    int value;
+    explicit NoDefault(int v) : value(v) {}
+};
+
+// Copy or assignment fails once 'budget' of them are done, the move may throw
+// as well, so containers copy it
+struct FragileCopy {
+    static int budget;
+    int value;
+    explicit FragileCopy(int v) : value(v) {}
+    FragileCopy(const FragileCopy& other) : value(other.value) {
+        if (budget-- == 0) throw std::runtime_error("copy");
+    }
+    FragileCopy(FragileCopy&& other) noexcept(false) : value(other.value) {}
+    FragileCopy& operator=(const FragileCopy& other) {
+        if (budget-- == 0) throw std::runtime_error("assign");
+        value = other.value;
+        return *this;
+    }
+    FragileCopy& operator=(FragileCopy&& other) noexcept(false) { return *this = other; }
+};
+int FragileCopy::budget = -1;
 
 TEST(TVectorTest, DefaultConstructor) {
     TVector<int> empty1, fake_empty(0);
@@ -178,9 +283,49 @@ TEST(TVectorTest, InsertCapacityOverflow) {
     for (int i = 0; i < 15; i++) {
         vec1.insert(1, 5);
     }
+    EXPECT_EQ(vec1.capacity(), 34);
+}
+
+TEST(TVectorTest, FixedGrowthCapacityOverflow) {
+    TVector<int, TFixedGrowth> vec1({ 1, 0 });
+    for (int i = 0; i < 15; i++) {
+        vec1.insert(1, 5);
+    }
     EXPECT_EQ(vec1.capacity(), 32);
 }
 
+TEST(TVectorTest, GeometricGrowthFactor) {
+    TVector<int, TGeometricGrowth<3, 2>> vec1;
+    for (int i = 0; i < 15; i++) {
+        vec1.push_back(i);
+    }
+    EXPECT_EQ(vec1.capacity(), 22);
+    for (int i = 0; i < 8; i++) {
+        vec1.push_back(i);
+    }
+    EXPECT_EQ(vec1.capacity(), 33);
+}
+
+TEST(TVectorTest, InitialCapacityConstructor) {
+    TVector<int, TFixedGrowth> vec1(TVectorCapacity{ 4 });
+    EXPECT_EQ(vec1.capacity(), 4);
+    for (int i = 0; i < 4; i++) {
+        vec1.push_back(i);
+    }
+    EXPECT_EQ(vec1.capacity(), 8);
+    EXPECT_EQ(vec1.initial_capacity(), 4);
+    EXPECT_EQ(vec1[3], 3);
+}
+
+TEST(TVectorTest, MovedFromIsUsable) {
+    TVector<int> vec1({ 1, 2, 3 });
+    TVector<int> vec2(std::move(vec1));
+    vec1.push_back(4);
+    EXPECT_EQ(vec1.size(), 1);
+    EXPECT_EQ(vec1[0], 4);
+    EXPECT_EQ(vec2.size(), 3);
+}
+
 TEST(TVectorTest, PopFront) {
     TVector<int> vec1({ 1, 2, 3, 4, 5 }), vec2({ 3, 4, 5 });
     vec1.pop_front();
@@ -284,4 +429,1330 @@ TEST(TVectorTest, Assign) {
     TVector<int> vec1({ 1, 2, 3, 4 }), vec2({ 37, 55, -19, 0, 0, 12 });
     vec1 = vec2;
     EXPECT_EQ(vec1 == vec2, true);
-}
\ No newline at end of file
+}
+TEST(TVectorTest, DirtyIndexedAccess) {
+    TVector<int> vec1;
+    for (int i = 0; i < 1000; i++) vec1.push_back(i);
+    for (int i = 0; i < 100; i++) vec1.erase(i * 9);
+    bool actual_result = true;
+    for (int i = 0, expected = 0; i < vec1.size(); i++, expected++) {
+        if (expected % 10 == 0) expected++;
+        if (vec1[i] != expected) actual_result = false;
+    }
+    for (int i = vec1.size() - 1; i >= 0; i -= 7) {
+        if (vec1[i] != i + i / 9 + 1) actual_result = false;
+    }
+    EXPECT_EQ(vec1.size(), 900);
+    EXPECT_EQ(actual_result, true);
+}
+
+TEST(TVectorTest, DirtyInsertAndPush) {
+    TVector<int> vec1;
+    for (int i = 0; i < 200; i++) vec1.push_back(i);
+    vec1.erase(10);
+    vec1.erase(20);
+    vec1.insert(5, -1);
+    vec1.push_back(-2);
+    vec1.insert(vec1.size(), -3);
+    EXPECT_EQ(vec1[5], -1);
+    EXPECT_EQ(vec1[11], 11);
+    EXPECT_EQ(vec1[21], 22);
+    EXPECT_EQ(vec1[vec1.size() - 2], -2);
+    EXPECT_EQ(vec1.back(), -3);
+    EXPECT_EQ(vec1.size(), 201);
+}
+
+TEST(TVectorTest, RandomOperationsMatchModel) {
+    TVector<int> vec1;
+    std::vector<int> model;
+    std::mt19937 gen(7);
+    bool actual_result = true;
+    for (int step = 0; step < 20000 && actual_result; step++) {
+        int op = gen() % 8;
+        int value = static_cast<int>(gen() % 1000);
+        if (op == 0 || op == 1) {
+            vec1.push_back(value);
+            model.push_back(value);
+        }
+        else if (op == 2) {
+            vec1.push_front(value);
+            model.insert(model.begin(), value);
+        }
+        else if (op == 3) {
+            size_t index = gen() % (model.size() + 1);
+            vec1.insert(index, value);
+            model.insert(model.begin() + index, value);
+        }
+        else if (op == 4 && !model.empty()) {
+            size_t index = gen() % model.size();
+            vec1.erase(index);
+            model.erase(model.begin() + index);
+        }
+        else if (op == 5 && !model.empty()) {
+            vec1.pop_front();
+            model.erase(model.begin());
+        }
+        else if (op == 6 && !model.empty()) {
+            vec1.pop_back();
+            model.pop_back();
+        }
+        else if (op == 7 && !model.empty()) {
+            size_t index = gen() % model.size();
+            if (vec1[index] != model[index]) actual_result = false;
+        }
+        if (vec1.size() != model.size()) actual_result = false;
+    }
+    for (size_t i = 0; i < model.size(); i++) {
+        if (vec1[i] != model[i]) actual_result = false;
+    }
+    EXPECT_EQ(actual_result, true);
+}
+
+TEST(TVectorTest, OnlyLiveElementsConstructed) {
+    {
+        TVector<Counted> vec1;
+        EXPECT_EQ(Counted::alive, 0);
+        for (int i = 0; i < 40; i++) vec1.push_back(Counted(i));
+        vec1.reserve(1000);
+        EXPECT_EQ(Counted::alive, 40);
+        vec1.erase(3);
+        vec1.pop_front();
+        vec1.pop_back();
+        EXPECT_EQ(Counted::alive, 37);
+        vec1.insert(5, Counted(-1));
+        vec1.push_front(Counted(-2));
+        vec1.shrink_to_fit();
+        EXPECT_EQ(Counted::alive, 39);
+        EXPECT_EQ(vec1[0].value, -2);
+        EXPECT_EQ(vec1[6].value, -1);
+        vec1.resize(10);
+        EXPECT_EQ(Counted::alive, 10);
+        vec1.clear();
+        EXPECT_EQ(Counted::alive, 0);
+        vec1.push_back(vec1.capacity() > 0 ? Counted(1) : Counted(2));
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(TVectorTest, StringElements) {
+    TVector<std::string> vec1;
+    for (int i = 0; i < 100; i++) vec1.push_back(std::string(30, static_cast<char>('a' + i % 26)));
+    vec1.erase(0);
+    vec1.insert(10, "inserted");
+    vec1.push_front(vec1[20]);
+    vec1.push_back(vec1[0]);
+    EXPECT_EQ(vec1[0], std::string(30, 'u'));
+    EXPECT_EQ(vec1[11], "inserted");
+    EXPECT_EQ(vec1.back(), std::string(30, 'u'));
+    EXPECT_EQ(vec1.size(), 102);
+}
+
+TEST(TVectorTest, MoveOnlyElements) {
+    TVector<std::unique_ptr<int>> vec1(20);
+    for (int i = 0; i < 20; i++) vec1[i] = std::make_unique<int>(i);
+    vec1.erase(2);
+    vec1.pop_front();
+    vec1.reserve(100);
+    vec1.resize(25);
+    EXPECT_EQ(*vec1[0], 1);
+    EXPECT_EQ(*vec1[1], 3);
+    EXPECT_EQ(vec1[24], nullptr);
+    EXPECT_EQ(vec1.size(), 25);
+}
+
+TEST(TVectorTest, NonDefaultConstructibleElements) {
+    TVector<NoDefault> vec1;
+    for (int i = 0; i < 30; i++) vec1.push_back(NoDefault(i));
+    vec1.erase(0);
+    vec1.insert(0, NoDefault(-1));
+    vec1.shrink_to_fit();
+    TVector<NoDefault> vec2(vec1);
+    EXPECT_EQ(vec2[0].value, -1);
+    EXPECT_EQ(vec2[29].value, 29);
+}
+
+TEST(TVectorTest, CopyDirtyTrivialAndNonTrivial) {
+    TVector<double> vec1;
+    TVector<std::string> vec2;
+    for (int i = 0; i < 300; i++) {
+        vec1.push_back(i);
+        vec2.push_back(std::to_string(i));
+    }
+    for (int i = 0; i < 40; i++) {
+        vec1.erase(i * 6);
+        vec2.erase(i * 6);
+    }
+    TVector<double> copy1(vec1);
+    TVector<std::string> copy2(vec2);
+    EXPECT_EQ(copy1 == vec1, true);
+    EXPECT_EQ(copy2 == vec2, true);
+    bool actual_result = true;
+    for (int i = 0; i < copy1.size(); i++) {
+        if (std::to_string(static_cast<int>(copy1[i])) != copy2[i]) actual_result = false;
+    }
+    EXPECT_EQ(actual_result, true);
+}
+
+TEST(TVectorTest, QueueWorkloadKeepsCapacity) {
+    TVector<int> vec1;
+    for (int i = 0; i < 10; i++) vec1.push_back(i);
+    for (int i = 10; i < 100000; i++) {
+        vec1.push_back(i);
+        vec1.pop_front();
+    }
+    EXPECT_EQ(vec1.size(), 10);
+    EXPECT_EQ(vec1.front(), 99990);
+    EXPECT_EQ(vec1.back(), 99999);
+    EXPECT_LE(vec1.capacity(), 30);
+}
+
+TEST(TVectorTest, DequeOperationsNonTrivial) {
+    TVector<std::string> vec1;
+    std::deque<std::string> model;
+    std::mt19937 gen(11);
+    bool actual_result = true;
+    for (int step = 0; step < 20000 && actual_result; step++) {
+        int op = gen() % 5;
+        std::string value = std::to_string(gen() % 1000);
+        if (op == 0) {
+            vec1.push_front(value);
+            model.push_front(value);
+        }
+        else if (op == 1) {
+            vec1.push_back(value);
+            model.push_back(value);
+        }
+        else if (op == 2 && !model.empty()) {
+            vec1.pop_front();
+            model.pop_front();
+        }
+        else if (op == 3 && !model.empty()) {
+            vec1.pop_back();
+            model.pop_back();
+        }
+        else if (op == 4 && !model.empty()) {
+            size_t index = gen() % model.size();
+            if (vec1[index] != model[index]) actual_result = false;
+        }
+        if (vec1.size() != model.size()) actual_result = false;
+    }
+    vec1.resize(model.size() + 50);
+    model.resize(model.size() + 50);
+    for (size_t i = 0; i < model.size(); i++) {
+        if (vec1[i] != model[i]) actual_result = false;
+    }
+    EXPECT_EQ(actual_result, true);
+}
+
+TEST(TVectorTest, IncrementalCompactionMatchesModel) {
+    TVector<std::string> vec1;
+    vec1.set_compaction(TVectorCompaction::incremental);
+    std::vector<std::string> model;
+    std::mt19937 gen(5);
+    for (int i = 0; i < 5000; i++) {
+        vec1.push_back(std::to_string(i));
+        model.push_back(std::to_string(i));
+    }
+    bool actual_result = true;
+    for (int step = 0; step < 20000 && actual_result; step++) {
+        int op = gen() % 6;
+        std::string value = std::to_string(gen() % 1000);
+        if (op == 0) {
+            size_t index = gen() % (model.size() + 1);
+            vec1.insert(index, value);
+            model.insert(model.begin() + index, value);
+        }
+        else if ((op == 1 || op == 2) && !model.empty()) {
+            size_t index = gen() % model.size();
+            vec1.erase(index);
+            model.erase(model.begin() + index);
+        }
+        else if (op == 3 && !model.empty()) {
+            vec1.pop_front();
+            model.erase(model.begin());
+        }
+        else if (op == 4 && !model.empty()) {
+            vec1.pop_back();
+            model.pop_back();
+        }
+        else if (op == 5 && !model.empty()) {
+            size_t index = gen() % model.size();
+            if (vec1[index] != model[index]) actual_result = false;
+        }
+        if (vec1.size() != model.size()) actual_result = false;
+    }
+    for (size_t i = 0; i < model.size(); i++) {
+        if (vec1[i] != model[i]) actual_result = false;
+    }
+    EXPECT_EQ(actual_result, true);
+}
+
+TEST(TVectorTest, CompactStepIsBounded) {
+    TVector<int> vec1(4000);
+    vec1.set_compaction(TVectorCompaction::incremental);
+    for (int i = 0; i < 4000; i++) vec1[i] = i;
+    for (int i = 0; i < 300; i++) vec1.erase(i * 10);
+    EXPECT_EQ(vec1.compact_step(10), false);
+    EXPECT_EQ(vec1[1], 2);
+    EXPECT_EQ(vec1[3699], 3999);
+    int steps = 0;
+    while (!vec1.compact_step(100)) steps++;
+    EXPECT_GT(steps, 5);
+    EXPECT_EQ(vec1.size(), 3700);
+    EXPECT_EQ(vec1[0], 1);
+    EXPECT_EQ(vec1[3699], 3999);
+}
+
+TEST(TVectorTest, AllocatorUsedForBothBuffers) {
+    AllocationLog log;
+    {
+        TVector<int, TGeometricGrowth<>, LoggingAllocator<int>> vec1{ LoggingAllocator<int>(&log) };
+        for (int i = 0; i < 100; i++) vec1.push_back(i);
+        vec1.erase(50);
+        TVector<int, TGeometricGrowth<>, LoggingAllocator<int>> vec2(vec1);
+        EXPECT_EQ(vec2[50], 51);
+        EXPECT_EQ(log.live, 4);
+    }
+    EXPECT_GT(log.state_allocations, 1);
+    EXPECT_EQ(log.live, 0);
+}
+
+TEST(TVectorTest, PmrArenaAndPool) {
+    TVectorArena arena;
+    TVectorPool pool;
+    pmr::TVector<std::pmr::string> vec1{ std::pmr::polymorphic_allocator<std::pmr::string>(&arena) };
+    pmr::TVector<std::pmr::string> vec2{ std::pmr::polymorphic_allocator<std::pmr::string>(&pool) };
+    for (int i = 0; i < 200; i++) {
+        vec1.push_back(std::pmr::string(40, static_cast<char>('a' + i % 26)));
+        vec2.push_front(std::pmr::string(40, static_cast<char>('a' + i % 26)));
+    }
+    EXPECT_EQ(vec1[199].get_allocator().resource(), &arena);
+    vec1.erase(0);
+    vec2 = std::move(vec1);
+    EXPECT_EQ(vec2.get_allocator().resource(), &pool);
+    EXPECT_EQ(vec2.size(), 199);
+    EXPECT_EQ(vec2[0], std::pmr::string(40, 'b'));
+    EXPECT_EQ(vec2[0].get_allocator().resource(), &pool);
+    EXPECT_EQ(vec1.size(), 0);
+}
+
+TEST(TVectorTest, SmallVectorSpillsOnGrowth) {
+    TSmallVector<int, 4> vec1;
+    EXPECT_EQ(vec1.is_inline(), true);
+    for (int i = 0; i < 4; i++) vec1.push_back(i);
+    EXPECT_EQ(vec1.is_inline(), true);
+    vec1.push_front(-1);
+    EXPECT_EQ(vec1.is_inline(), false);
+    EXPECT_EQ(vec1.capacity(), 15);
+    vec1.pop_back();
+    vec1.pop_back();
+    vec1.shrink_to_fit();
+    EXPECT_EQ(vec1.is_inline(), true);
+    EXPECT_EQ(vec1[0], -1);
+    EXPECT_EQ(vec1[2], 1);
+    EXPECT_EQ(vec1.size(), 3);
+}
+
+TEST(TVectorTest, SmallVectorMoves) {
+    Counted::alive = 0;
+    {
+        TSmallVector<Counted, 4> vec1;
+        TSmallVector<Counted, 4> vec2;
+        for (int i = 0; i < 3; i++) vec1.push_back(Counted(i));
+        for (int i = 0; i < 20; i++) vec2.push_back(Counted(i));
+        TSmallVector<Counted, 4> vec3(std::move(vec1));
+        TSmallVector<Counted, 4> vec4(std::move(vec2));
+        EXPECT_EQ(vec3.is_inline(), true);
+        EXPECT_EQ(vec4.is_inline(), false);
+        EXPECT_EQ(vec1.is_inline(), true);
+        EXPECT_EQ(vec2.is_inline(), true);
+        EXPECT_EQ(vec1.size(), 0);
+        EXPECT_EQ(vec3[2].value, 2);
+        EXPECT_EQ(vec4[19].value, 19);
+        vec3 = std::move(vec4);
+        EXPECT_EQ(vec3.size(), 20);
+        vec4.push_back(Counted(7));
+        vec3 = std::move(vec4);
+        EXPECT_EQ(vec3.size(), 1);
+        EXPECT_EQ(vec3.is_inline(), true);
+        EXPECT_EQ(vec3[0].value, 7);
+        vec1.push_back(Counted(1));
+        EXPECT_EQ(Counted::alive, 2);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(TVectorTest, SmallVectorMatchesModel) {
+    TSmallVector<std::string, 8> vec1;
+    std::vector<std::string> model;
+    std::mt19937 gen(3);
+    bool actual_result = true;
+    for (int step = 0; step < 5000 && actual_result; step++) {
+        int op = gen() % 7;
+        std::string value = std::to_string(gen() % 1000);
+        if (op == 0 || (op == 1 && model.size() < 6)) {
+            size_t index = gen() % (model.size() + 1);
+            vec1.insert(index, value);
+            model.insert(model.begin() + index, value);
+        }
+        else if ((op == 2 || op == 3) && !model.empty()) {
+            size_t index = gen() % model.size();
+            vec1.erase(index);
+            model.erase(model.begin() + index);
+        }
+        else if (op == 4) {
+            vec1.shrink_to_fit();
+        }
+        else if (op == 5) {
+            TSmallVector<std::string, 8> moved(std::move(vec1));
+            vec1 = std::move(moved);
+        }
+        if (vec1.size() != model.size()) actual_result = false;
+    }
+    for (size_t i = 0; i < model.size(); i++) {
+        if (vec1[i] != model[i]) actual_result = false;
+    }
+    EXPECT_EQ(actual_result, true);
+}
+
+#if __cplusplus >= 202002L
+static_assert(std::random_access_iterator<TVector<int>::iterator>);
+static_assert(std::random_access_iterator<TVector<int>::const_iterator>);
+static_assert(std::ranges::random_access_range<TVector<std::string>>);
+static_assert(std::ranges::sized_range<TVector<int>>);
+#endif
+
+TEST(TVectorTest, IteratorsSkipTombstones) {
+    TVector<int> vec1;
+    std::vector<int> model;
+    for (int i = 0; i < 1000; i++) {
+        vec1.push_back(i);
+        model.push_back(i);
+    }
+    for (int i = 0; i < 100; i++) {
+        vec1.erase(i * 7 + 3);
+        model.erase(model.begin() + i * 7 + 3);
+    }
+    std::vector<int> visited;
+    for (int value : vec1) visited.push_back(value);
+    EXPECT_EQ(visited, model);
+    EXPECT_EQ(vec1.end() - vec1.begin(), 900);
+    EXPECT_EQ(*(vec1.begin() + 500), model[500]);
+    EXPECT_EQ(vec1.begin()[899], model[899]);
+    EXPECT_EQ(*std::prev(vec1.end()), model.back());
+    EXPECT_EQ(std::find(vec1.cbegin(), vec1.cend(), 998) - vec1.cbegin(), 898);
+    std::vector<int> reversed(std::make_reverse_iterator(vec1.end()), std::make_reverse_iterator(vec1.begin()));
+    EXPECT_EQ(reversed, std::vector<int>(model.rbegin(), model.rend()));
+}
+
+TEST(TVectorTest, IteratorsWithAlgorithms) {
+    TVector<int> vec1;
+    for (int i = 0; i < 300; i++) vec1.push_front(i);
+    for (int i = 0; i < 20; i++) vec1.erase(i * 11);
+    std::sort(vec1.begin(), vec1.end());
+    EXPECT_EQ(std::is_sorted(vec1.begin(), vec1.end()), true);
+    vec1.shrink_to_fit();
+    std::reverse(vec1.begin(), vec1.end());
+    EXPECT_EQ(std::is_sorted(vec1.begin(), vec1.end(), std::greater<int>()), true);
+    TVector<int>::const_iterator it = vec1.begin();
+    EXPECT_EQ(*it, vec1[0]);
+    EXPECT_EQ(vec1.end() - vec1.begin(), 280);
+}
+
+template<class T> static bool search_matches_model(const std::vector<T>& values, const T& needle) {
+    TVector<T> vec1;
+    std::vector<T> model;
+    for (size_t i = 0; i < values.size(); i++) {
+        vec1.push_back(values[i]);
+        model.push_back(values[i]);
+    }
+    for (size_t i = 0; i < model.size() / 9; i++) {
+        vec1.erase(i * 8 + 1);
+        model.erase(model.begin() + i * 8 + 1);
+    }
+    std::vector<int> expected;
+    for (size_t i = 0; i < model.size(); i++) {
+        if (model[i] == needle) expected.push_back(static_cast<int>(i));
+    }
+    int first = expected.empty() ? -1 : expected.front();
+    int last = expected.empty() ? -1 : expected.back();
+    return find_all(vec1, needle) == expected && find_first(vec1, needle) == first && find_last(vec1, needle) == last;
+}
+
+template<class T> static bool search_all_levels(int modulo) {
+    std::vector<T> values;
+    for (int i = 0; i < 1000; i++) values.push_back(static_cast<T>(i * 7 % modulo));
+    bool result = true;
+    TVectorSimdLevel levels[] = { TVectorSimdLevel::avx2, TVectorSimdLevel::sse2, TVectorSimdLevel::scalar };
+    for (TVectorSimdLevel level : levels) {
+        tvector_set_simd_level(level);
+        result = result && search_matches_model<T>(values, static_cast<T>(3)) && search_matches_model<T>(values, static_cast<T>(-1));
+    }
+    tvector_set_simd_level(TVectorSimdLevel::avx2);
+    return result;
+}
+
+TEST(TVectorTest, SearchArithmeticTypes) {
+    EXPECT_EQ(search_all_levels<char>(100), true);
+    EXPECT_EQ(search_all_levels<unsigned short>(300), true);
+    EXPECT_EQ(search_all_levels<int>(300), true);
+    EXPECT_EQ(search_all_levels<long long>(300), true);
+    EXPECT_EQ(search_all_levels<float>(300), true);
+    EXPECT_EQ(search_all_levels<double>(300), true);
+}
+
+TEST(TVectorTest, SearchNonArithmeticAndEmpty) {
+    TVector<std::string> vec1{ "a", "b", "a", "c" };
+    vec1.erase(1);
+    EXPECT_EQ(find_first(vec1, std::string("a")), 0);
+    EXPECT_EQ(find_last(vec1, std::string("a")), 1);
+    EXPECT_EQ(find_all(vec1, std::string("c")), std::vector<int>{ 2 });
+    EXPECT_EQ(find_all(vec1, std::string("z")).empty(), true);
+    TVector<int> vec2;
+    ASSERT_ANY_THROW(find_first(vec2, 1));
+
+    // Tombstones between live slots hold destroyed strings and are never compared
+    TVector<std::string> vec3;
+    for (int i = 0; i < 40; i++) vec3.push_back(std::string(32, static_cast<char>('a' + i % 4)));
+    vec3.erase(5);
+    std::string needle(32, 'b');
+    EXPECT_EQ(find_first(vec3, needle), 1);
+    EXPECT_EQ(find_last(vec3, needle), 36);
+    EXPECT_EQ(find_all(vec3, needle).size(), 9);
+    EXPECT_EQ(find_all(vec3, needle)[1], 8);
+}
+
+TEST(TVectorTest, ParallelAlgorithmsMatchSerial) {
+    TVectorThreadPool pool(4);
+    TVectorParallelPolicy policy = tvector_par.on(pool).with_grain(64);
+    TVector<int> vec;
+    for (int i = 0; i < 20000; i++) vec.push_back(i % 97);
+    for (int i = 0; i < 2000; i++) vec.erase((i * 7919) % vec.size());
+    std::vector<int> model(vec.begin(), vec.end());
+    long long sum = 0;
+    for (int value : model) sum += value;
+
+    EXPECT_EQ(find_first(policy, vec, 42), find_first(vec, 42));
+    EXPECT_EQ(find_last(policy, vec, 42), find_last(vec, 42));
+    EXPECT_EQ(find_all(policy, vec, 42), find_all(vec, 42));
+    EXPECT_EQ(find_first(policy, vec, 500), -1);
+    EXPECT_EQ(find_last(policy, vec, 500), -1);
+    EXPECT_EQ(count(policy, vec, 42), static_cast<size_t>(std::count(model.begin(), model.end(), 42)));
+    EXPECT_EQ(count_if(policy, vec, [](int x) { return x > 50; }),
+              static_cast<size_t>(std::count_if(model.begin(), model.end(), [](int x) { return x > 50; })));
+    EXPECT_EQ(reduce(policy, vec, 0LL), sum);
+
+    // The chunk results are combined in order
+    TVector<std::string> words;
+    for (int i = 0; i < 3000; i++) words.push_back(std::string(1, static_cast<char>('a' + i % 26)));
+    words.erase(5);
+    std::string joined;
+    for (const std::string& word : words) joined += word;
+    EXPECT_EQ(reduce(policy, words, std::string()), joined);
+
+    TVector<std::string> long_words;
+    for (int i = 0; i < 3000; i++) long_words.push_back(std::string(32, static_cast<char>('a' + i % 26)));
+    for (int i = 0; i < 200; i++) long_words.erase(static_cast<size_t>(i * 13));
+    std::string needle(32, 'q');
+    EXPECT_EQ(find_first(policy, long_words, needle), find_first(long_words, needle));
+    EXPECT_EQ(find_last(policy, long_words, needle), find_last(long_words, needle));
+    EXPECT_EQ(find_all(policy, long_words, needle), find_all(long_words, needle));
+    EXPECT_EQ(count(policy, long_words, needle), find_all(long_words, needle).size());
+
+    std::vector<long long> squares(vec.size());
+    transform(policy, vec, squares.begin(), [](int x) { return static_cast<long long>(x) * x; });
+    bool same = true;
+    for (size_t i = 0; i < model.size(); i++) same = same && squares[i] == static_cast<long long>(model[i]) * model[i];
+    EXPECT_EQ(same, true);
+
+    for_each(policy, vec, [](int& x) { x += 1; });
+    transform(policy, vec, [](int x) { return x * 2; });
+    for (size_t i = 0; i < model.size(); i++) same = same && vec[i] == (model[i] + 1) * 2;
+    EXPECT_EQ(same, true);
+}
+
+TEST(TVectorTest, ParallelPoolRethrows) {
+    TVectorThreadPool pool(3);
+    TVector<int> vec(100000);
+    auto failing = [](int& x) { if (x == 0) throw std::runtime_error("task"); };
+    ASSERT_ANY_THROW(for_each(tvector_par.on(pool).with_grain(64), vec, failing));
+    // The pool stays usable after a failed batch
+    EXPECT_EQ(count(tvector_par.on(pool).with_grain(64), vec, 0), static_cast<size_t>(100000));
+}
+
+TEST(TVectorTest, RangeInsertAndAppend) {
+    TVector<int> vec1{ 1, 2, 3, 4 };
+    std::vector<int> values{ 10, 11, 12 };
+    vec1.erase(1);
+    vec1.insert(1, values.begin(), values.end());
+    vec1.append(values.begin(), values.begin() + 2);
+    vec1.insert(0, values.begin() + 2, values.end());
+    EXPECT_EQ(vec1 == TVector<int>({ 12, 1, 10, 11, 12, 3, 4, 10, 11 }), true);
+    // Ranges from the vector itself and single pass input
+    vec1.insert(2, vec1.begin(), vec1.begin() + 3);
+    EXPECT_EQ(vec1 == TVector<int>({ 12, 1, 12, 1, 10, 10, 11, 12, 3, 4, 10, 11 }), true);
+    std::istringstream input("7 8 9");
+    vec1.insert(1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+    EXPECT_EQ(vec1.size(), 15);
+    EXPECT_EQ(vec1[1] == 7 && vec1[3] == 9 && vec1[4] == 1, true);
+
+    TVector<std::string> vec2{ "a", "e" };
+    std::vector<std::string> middle{ "b", "c", "d" };
+    vec2.insert(1, middle.begin(), middle.end());
+    vec2.append(middle.rbegin(), middle.rend());
+    EXPECT_EQ(vec2 == TVector<std::string>({ "a", "b", "c", "d", "e", "d", "c", "b" }), true);
+
+    // One reservation for the whole range
+    TVector<int> vec3;
+    std::vector<int> many(1000, 5);
+    vec3.append(many.begin(), many.end());
+    EXPECT_EQ(vec3.size(), 1000);
+    EXPECT_EQ(vec3.capacity() > 1000 && vec3.capacity() <= 1015, true);
+}
+
+TEST(TVectorTest, BatchEraseMatchesModel) {
+    std::mt19937 gen(11);
+    for (int mode = 0; mode < 2; mode++) {
+        TVector<Counted> vec;
+        std::vector<int> model;
+        vec.set_compaction(mode == 0 ? TVectorCompaction::eager : TVectorCompaction::incremental);
+        for (int i = 0; i < 3000; i++) {
+            vec.push_back(Counted(i));
+            model.push_back(i);
+        }
+        for (int round = 0; round < 20; round++) {
+            size_t single = gen() % vec.size();
+            vec.erase(single);
+            model.erase(model.begin() + single);
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < model.size(); i++) {
+                if (gen() % 10 == 0 || i == 0 || i + 1 == model.size()) indices.push_back(i);
+            }
+            vec.erase(indices);
+            for (size_t i = indices.size(); i > 0; i--) model.erase(model.begin() + indices[i - 1]);
+            int divisor = 7 + round;
+            size_t removed = vec.erase_if([&](const Counted& c) { return c.value % divisor == 0; });
+            size_t before = model.size();
+            model.erase(std::remove_if(model.begin(), model.end(), [&](int v) { return v % divisor == 0; }), model.end());
+            EXPECT_EQ(removed, before - model.size());
+            ASSERT_EQ(vec.size(), model.size());
+            bool same = true;
+            for (size_t i = 0; i < model.size(); i++) same = same && vec[i].value == model[i];
+            EXPECT_EQ(same, true);
+        }
+        EXPECT_EQ(vec.erase_if([](const Counted&) { return true; }), model.size());
+        EXPECT_EQ(vec.size(), 0);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+
+    TVector<int> vec{ 1, 2, 3 };
+    ASSERT_ANY_THROW(vec.erase(std::vector<size_t>{ 2, 1 }));
+    ASSERT_ANY_THROW(vec.erase(std::vector<size_t>{ 1, 3 }));
+    EXPECT_EQ(vec.size(), 3);
+}
+
+TEST(TVectorTest, MoveOnlyInsertion) {
+    TVector<std::unique_ptr<int>> vec;
+    for (int i = 0; i < 40; i++) vec.push_back(std::make_unique<int>(i));
+    std::unique_ptr<int> front = std::make_unique<int>(-1);
+    vec.push_front(std::move(front));
+    EXPECT_EQ(front == nullptr, true);
+    vec.emplace_front(new int(-2));
+    EXPECT_EQ(*vec.emplace_back(new int(40)), 40);
+    EXPECT_EQ(*vec.emplace_at(3, new int(100)), 100);
+    vec.insert(5, std::make_unique<int>(200));
+    vec.erase(10);
+    vec.emplace(0, std::make_unique<int>(-3));
+    EXPECT_EQ(vec.size(), 44);
+    EXPECT_EQ(*vec[0] == -3 && *vec[1] == -1 && *vec[2] == 0 && *vec[3] == 100 && *vec[5] == 200, true);
+    EXPECT_EQ(*vec[43], 40);
+    TVector<std::unique_ptr<int>> moved(std::move(vec));
+    EXPECT_EQ(*moved[3], 100);
+}
+
+TEST(TVectorTest, EmplaceConstructsInPlace) {
+    Counted::alive = 0;
+    struct Pair {
+        Counted first;
+        int second;
+        Pair(int a, int b) : first(a), second(b) {}
+    };
+    TVector<Pair> vec1;
+    vec1.emplace_back(1, 2);
+    vec1.emplace_front(3, 4);
+    vec1.emplace_at(1, 5, 6);
+    EXPECT_EQ(vec1[0].first.value == 3 && vec1[1].first.value == 5 && vec1[2].second == 2, true);
+
+    // Arguments that refer to an element survive the reallocation they trigger
+    TVector<std::string> vec2{ "first" };
+    for (int i = 0; i < 100; i++) vec2.emplace_back(vec2[0]);
+    for (int i = 0; i < 100; i++) vec2.emplace_front(vec2[vec2.size() - 1]);
+    vec2.emplace_at(50, vec2[0], 2);
+    EXPECT_EQ(vec2.size(), 202);
+    EXPECT_EQ(vec2[0] == "first" && vec2[201] == "first" && vec2[50] == "rst", true);
+    std::string moved = "a string too long for the small string buffer";
+    vec2.push_back(std::move(moved));
+    EXPECT_EQ(vec2[202], "a string too long for the small string buffer");
+}
+
+TEST(TVectorTest, StatsCountHotPaths) {
+    TVectorStatsRegistry& registry = TVectorStatsRegistry::instance();
+    registry.reset();
+    registry.set_enabled(true);
+    {
+        TVector<int> vec;
+        for (int i = 0; i < 1000; i++) vec.push_back(i);
+        TVectorStats grown = vec.stats();
+        EXPECT_EQ(grown.reallocations > 0 && grown.allocations >= 2 * grown.reallocations, true);
+        EXPECT_EQ(grown.bytes_moved > 0, true);
+
+        vec.insert(500, -1);
+        EXPECT_EQ(vec.stats().shifts, 1);
+        for (int i = 0; i < 100; i++) vec.erase(1 + i * 5);
+        int sum = 0;
+        for (size_t i = 0; i < vec.size(); i += 37) sum += vec[i];
+        TVectorStats dirty = vec.stats();
+        EXPECT_EQ(dirty.cleanups, 0);
+        EXPECT_EQ(dirty.translations > 0 && dirty.translation_words > 0, true);
+        EXPECT_EQ(dirty.tombstone_peak > 0.09 && dirty.tombstone_peak < 0.15, true);
+        for (int i = 0; i < 100; i++) vec.erase(1 + i * 3);
+        EXPECT_EQ(vec.stats().cleanups, 1);
+        EXPECT_EQ(vec.stats().tombstone_peak > 0.14, true);
+
+        TVector<int> copy(vec);
+        EXPECT_EQ(copy.stats().cleanups, 0);
+        EXPECT_EQ(registry.live(), 2);
+        EXPECT_EQ(copy.stats().allocations, 2);
+        copy.reset_stats();
+        EXPECT_EQ(copy.stats().allocations, 0);
+        EXPECT_EQ(sum != 0, true);
+    }
+    EXPECT_EQ(registry.live(), 0);
+    EXPECT_EQ(registry.total().cleanups, 1);
+    std::ostringstream out;
+    registry.write(out);
+    EXPECT_EQ(out.str().find("tvector_cleanups 1\n") != std::string::npos, true);
+    registry.set_enabled(false);
+    registry.reset();
+}
+
+TEST(TVectorTest, MappedVectorPersists) {
+    std::string path = testing::TempDir() + "tvector_mapped.bin";
+    std::remove(path.c_str());
+    std::vector<int> model;
+    {
+        TMappedVector<int> vec(path, 4);
+        for (int i = 0; i < 1000; i++) {
+            vec.push_back(i);
+            model.push_back(i);
+        }
+        EXPECT_EQ(vec.capacity() > 1000, true);
+        for (int i = 0; i < 50; i++) {
+            vec.erase(static_cast<size_t>(i * 7));
+            model.erase(model.begin() + i * 7);
+        }
+        vec.emplace(10, -10);
+        model[10] = -10;
+        EXPECT_EQ(vec.is_clean(), false);
+        vec.flush();
+    }
+    {
+        TMappedVector<int> vec(path);
+        EXPECT_EQ(vec.size(), model.size());
+        EXPECT_EQ(vec.is_clean(), false);
+        for (size_t i = 0; i < model.size(); i++) EXPECT_EQ(vec[i], model[i]);
+        vec.pop_back();
+        model.pop_back();
+        vec.reserve(4096);
+        EXPECT_EQ(vec.is_clean(), true);
+        EXPECT_EQ(vec.capacity(), 4096);
+        for (size_t i = 0; i < model.size(); i++) EXPECT_EQ(vec.at(i), model[i]);
+        EXPECT_EQ(vec.back(), model.back());
+        EXPECT_ANY_THROW(vec.at(model.size()));
+    }
+    EXPECT_ANY_THROW(TMappedVector<double>{ path });
+    std::remove(path.c_str());
+}
+
+TEST(TVectorTest, SaveLoadRoundTrip) {
+    TVector<int> vec;
+    for (int i = 0; i < 5000; i++) vec.push_back(i);
+    for (int i = 0; i < 100; i++) vec.erase(static_cast<size_t>(i * 11));
+    std::vector<char> buffer;
+    vec.save(buffer);
+    EXPECT_EQ(buffer.size(), 16 + 8 + vec.size() * sizeof(int) + 8);
+
+    TVector<int> loaded({ 1, 2, 3 });
+    EXPECT_EQ(loaded.load(buffer.data(), buffer.size()), buffer.size());
+    EXPECT_EQ(loaded == vec, true);
+
+    std::stringstream stream;
+    vec.save(stream);
+    TVector<int> streamed;
+    streamed.load(stream);
+    EXPECT_EQ(streamed == vec, true);
+
+    TVector<std::string> words({ "alpha", "", "gamma" });
+    words.erase(1);
+    std::stringstream text;
+    words.save(text);
+    TVector<std::string> read_words;
+    read_words.load(text);
+    EXPECT_EQ(read_words.size(), 2);
+    EXPECT_EQ(read_words[1], "gamma");
+
+    // Rejected input leaves the vector as it was
+    TVector<short> other({ 7 });
+    EXPECT_ANY_THROW(other.load(buffer.data(), buffer.size()));
+    EXPECT_ANY_THROW(loaded.load(buffer.data(), buffer.size() - 1));
+    EXPECT_EQ(other.size(), 1);
+    EXPECT_EQ(loaded == vec, true);
+}
+
+TEST(TVectorTest, StreamReaderAppendsChunks) {
+    std::stringstream stream;
+    TVectorStreamWriter<int> writer(stream);
+    std::vector<int> model;
+    for (int chunk = 0; chunk < 10; chunk++) {
+        std::vector<int> part(static_cast<size_t>(chunk * 100 + 1), chunk);
+        writer.write(part.data(), part.size());
+        model.insert(model.end(), part.begin(), part.end());
+    }
+    writer.chunk(3);
+    EXPECT_ANY_THROW(writer.finish());
+    int tail[3] = { -1, -2, -3 };
+    writer.elements(tail, 2);
+    writer.elements(tail + 2, 1);
+    model.insert(model.end(), tail, tail + 3);
+    writer.finish();
+
+    TVector<int> vec({ 100, 200 });
+    vec.erase(0);
+    model.insert(model.begin(), 200);
+    TVectorStreamReader<int> reader(stream);
+    EXPECT_EQ(reader.read_chunk(vec), true);
+    EXPECT_EQ(vec.size(), 2);
+    EXPECT_EQ(reader.read_all(vec), model.size() - 2);
+    EXPECT_EQ(reader.is_done(), true);
+    EXPECT_EQ(reader.read_chunk(vec), false);
+    EXPECT_EQ(vec.size(), model.size());
+    for (size_t i = 0; i < model.size(); i++) EXPECT_EQ(vec[i], model[i]);
+}
+
+TEST(TVectorTest, CowVectorSharesUntilWrite) {
+    TVector<int> source;
+    for (int i = 0; i < 1000; i++) source.push_back(i);
+    TCowVector<int> owner(std::move(source));
+    owner.erase(0);
+    owner.erase(500);
+
+    // A dirty vector is copied, never compacted through a const source
+    TCowVector<int> dirty(owner);
+    EXPECT_EQ(dirty.is_shared(), false);
+    EXPECT_EQ(dirty.size(), 998);
+    EXPECT_EQ(dirty[500], 502);
+    owner.compact();
+
+    TCowVector<int> snapshot(owner);
+    EXPECT_EQ(snapshot.is_shared(), true);
+    EXPECT_EQ(&snapshot.view() == &owner.view(), true);
+    EXPECT_EQ(snapshot.size(), 998);
+    EXPECT_EQ(snapshot[500], 502);
+
+    owner.push_back(1000);
+    owner[0] = -1;
+    EXPECT_EQ(owner.is_shared(), false);
+    EXPECT_EQ(snapshot.is_shared(), false);
+    EXPECT_EQ(snapshot.size(), 998);
+    EXPECT_EQ(snapshot[0], 1);
+    EXPECT_EQ(owner[0], -1);
+    EXPECT_EQ(owner.back(), 1000);
+
+    TCowVector<int> other = snapshot;
+    other.clear();
+    EXPECT_EQ(other.is_empty(), true);
+    EXPECT_EQ(snapshot.size(), 998);
+    other = snapshot;
+    EXPECT_EQ(other == snapshot, true);
+
+    // Readers on snapshots while the owner keeps writing
+    std::vector<std::thread> readers;
+    std::atomic<long long> total(0);
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([copy = TCowVector<int>(owner), &total]() {
+            long long sum = 0;
+            for (size_t i = 0; i < copy.size(); i++) sum += copy[i];
+            for (int value : copy) sum -= value;
+            total += sum;
+        });
+        owner.erase(10);
+    }
+    for (std::thread& reader : readers) reader.join();
+    EXPECT_EQ(total.load(), 0);
+
+    // A handed-out reference never writes into later snapshots
+    TCowVector<int> first({ 1, 2, 3 });
+    int& element = first[0];
+    TCowVector<int> second = first;
+    element = 99;
+    EXPECT_EQ(second[0], 1);
+    EXPECT_EQ(first[0], 99);
+    TCowVector<int> third({ 4 });
+    third = first;
+    element = 100;
+    EXPECT_EQ(third[0], 99);
+    EXPECT_EQ(std::as_const(first).at(0), 100);
+
+    // Copying one dirty const handle from several threads only reads it
+    TCowVector<int> sparse({ 1, 2, 3, 4, 5, 6, 7, 8 });
+    sparse.erase(2);
+    const TCowVector<int>& handle = sparse;
+    std::vector<std::thread> copiers;
+    std::atomic<size_t> copied(0);
+    for (int t = 0; t < 4; t++) {
+        copiers.emplace_back([&handle, &copied]() { copied += TCowVector<int>(handle).size(); });
+    }
+    for (std::thread& copier : copiers) copier.join();
+    EXPECT_EQ(copied.load(), 28);
+}
+
+TEST(TVectorTest, ConcurrentVectorPublishesAll) {
+    TConcurrentVector<std::string> vec;
+    EXPECT_EQ(vec.is_empty(), true);
+    EXPECT_EQ(vec.is_published(0), false);
+    EXPECT_ANY_THROW(vec.at(0));
+
+    const int producers = 4;
+    const int per_thread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < producers; t++) {
+        threads.emplace_back([&vec, t]() {
+            for (int i = 0; i < per_thread; i++) {
+                size_t index = vec.emplace_back(std::to_string(t * per_thread + i));
+                EXPECT_EQ(vec[index], std::to_string(t * per_thread + i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    EXPECT_EQ(vec.size(), producers * per_thread);
+    EXPECT_EQ(vec.capacity() >= vec.size(), true);
+    std::vector<int> seen(producers * per_thread, 0);
+    vec.for_each([&seen](const std::string& value) { seen[std::stoi(value)]++; });
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), producers * per_thread);
+    for (size_t i = 0; i < vec.size(); i++) EXPECT_EQ(vec.is_published(i), true);
+
+    // Published elements never move
+    const std::string* first = &vec.at(0);
+    vec.reserve(1 << 16);
+    EXPECT_EQ(vec.capacity() >= (1 << 16), true);
+    EXPECT_EQ(&vec.at(0), first);
+
+    // Producers crossing into a new segment allocate it once
+    shared_allocations = 0;
+    TConcurrentVector<int, SharedCountingAllocator<int>> counted;
+    std::vector<std::thread> racers;
+    for (int t = 0; t < 8; t++) {
+        racers.emplace_back([&counted]() {
+            for (int i = 0; i < 4000; i++) counted.push_back(i);
+        });
+    }
+    for (std::thread& racer : racers) racer.join();
+    EXPECT_EQ(counted.capacity(), (size_t(64) << shared_allocations.load()) - 64);
+}
+
+TEST(TVectorTest, ShuffleIsReproduciblePermutation) {
+    TVector<int> vec;
+    for (int i = 0; i < 3000; i++) vec.push_back(i);
+    for (int i = 0; i < 200; i++) vec.erase(static_cast<size_t>(i * 13));
+    std::vector<int> model(vec.begin(), vec.end());
+    TVector<int> other(vec);
+
+    TVectorRng first(42);
+    TVectorRng second(42);
+    vectorShuffle(vec, first);
+    vectorShuffle(other, second);
+    EXPECT_EQ(vec == other, true);
+    std::vector<int> shuffled(vec.begin(), vec.end());
+    EXPECT_EQ(shuffled != model, true);
+    std::sort(shuffled.begin(), shuffled.end());
+    EXPECT_EQ(shuffled == model, true);
+
+    // The same seed gives the same permutation on any pool
+    TVectorThreadPool one(1);
+    TVectorThreadPool three(3);
+    TVector<int> a;
+    for (int i = 0; i < 10000; i++) a.push_back(i);
+    TVector<int> b(a);
+    vectorShuffle(tvector_par.on(one).with_grain(100), a, 7);
+    vectorShuffle(tvector_par.on(three).with_grain(100), b, 7);
+    EXPECT_EQ(a == b, true);
+    std::vector<int> merged(a.begin(), a.end());
+    std::sort(merged.begin(), merged.end());
+    for (int i = 0; i < 10000; i++) EXPECT_EQ(merged[i], i);
+
+    // Every value lands on the first position about equally often
+    std::vector<int> hits(8, 0);
+    TVectorRng rng(1);
+    for (int round = 0; round < 8000; round++) {
+        TVector<int> small({ 0, 1, 2, 3, 4, 5, 6, 7 });
+        small.erase(0);
+        small.push_front(0);
+        vectorShuffle(tvector_par.on(one).with_grain(1), small, rng());
+        hits[small[0]]++;
+    }
+    for (int count : hits) EXPECT_EQ(count > 850 && count < 1150, true);
+}
+
+TEST(TVectorTest, SamplingWithoutReplacement) {
+    TVector<int> vec;
+    for (int i = 0; i < 10000; i++) vec.push_back(i);
+    vec.erase(5);
+    TVectorRng rng(3);
+    for (size_t k : { size_t(0), size_t(10), size_t(5000), size_t(9999) }) {
+        std::vector<int> sample = vectorSample(vec, k, rng);
+        EXPECT_EQ(sample.size(), k);
+        EXPECT_EQ(std::is_sorted(sample.begin(), sample.end()), true);
+        EXPECT_EQ(std::adjacent_find(sample.begin(), sample.end()) == sample.end(), true);
+        EXPECT_EQ(std::find(sample.begin(), sample.end(), 5) == sample.end(), true);
+    }
+    EXPECT_ANY_THROW(vectorSample(vec, 10000, rng));
+
+    std::vector<int> reservoir = vectorReservoirSample(vec.begin(), vec.end(), 100, rng);
+    EXPECT_EQ(reservoir.size(), 100);
+    std::sort(reservoir.begin(), reservoir.end());
+    EXPECT_EQ(std::adjacent_find(reservoir.begin(), reservoir.end()) == reservoir.end(), true);
+    EXPECT_EQ(reservoir.back() > 1000, true);
+    std::istringstream words("a b c");
+    std::vector<std::string> all = vectorReservoirSample(std::istream_iterator<std::string>(words), std::istream_iterator<std::string>(), 5, rng);
+    EXPECT_EQ(all.size(), 3);
+}
+
+TEST(TVectorTest, SortMatchesStdSort) {
+    std::mt19937 gen(5);
+    TVector<int> ints;
+    TVector<double> doubles;
+    TVector<std::string> strings;
+    for (int i = 0; i < 5000; i++) {
+        ints.push_back(static_cast<int>(gen() - (1u << 30)));
+        doubles.push_back(std::uniform_real_distribution<double>(-1e6, 1e6)(gen));
+        strings.push_back(std::to_string(gen() % 1000));
+    }
+    doubles.push_back(-0.0);
+    doubles.push_back(0.0);
+    for (int i = 0; i < 300; i++) {
+        ints.erase(static_cast<size_t>(i * 7));
+        doubles.erase(static_cast<size_t>(i * 7));
+        strings.erase(static_cast<size_t>(i * 7));
+    }
+    std::vector<int> int_model(ints.begin(), ints.end());
+    std::vector<double> double_model(doubles.begin(), doubles.end());
+    std::vector<std::string> string_model(strings.begin(), strings.end());
+    std::sort(int_model.begin(), int_model.end());
+    std::stable_sort(double_model.begin(), double_model.end());
+    std::sort(string_model.begin(), string_model.end());
+
+    TVector<int> parallel_ints(ints);
+    vectorSort(ints);
+    vectorStableSort(doubles);
+    vectorSort(strings);
+    EXPECT_EQ(std::equal(ints.begin(), ints.end(), int_model.begin(), int_model.end()), true);
+    EXPECT_EQ(std::equal(strings.begin(), strings.end(), string_model.begin(), string_model.end()), true);
+    for (size_t i = 0; i < double_model.size(); i++) {
+        EXPECT_EQ(doubles[i], double_model[i]);
+        EXPECT_EQ(std::signbit(doubles[i]), std::signbit(double_model[i]));
+    }
+
+    TVectorThreadPool pool(3);
+    vectorSort(tvector_par.on(pool).with_grain(100), parallel_ints);
+    EXPECT_EQ(parallel_ints == ints, true);
+    vectorStableSort(tvector_par.on(pool).with_grain(100), parallel_ints, std::greater<int>());
+    EXPECT_EQ(std::is_sorted(parallel_ints.begin(), parallel_ints.end(), std::greater<int>()), true);
+
+    TVector<unsigned char> bytes;
+    for (int i = 0; i < 1000; i++) bytes.push_back(static_cast<unsigned char>(gen()));
+    vectorSort(bytes);
+    EXPECT_EQ(std::is_sorted(bytes.begin(), bytes.end()), true);
+
+    TVector<int> partial;
+    for (int i = 100; i > 0; i--) partial.push_back(i);
+    partial.erase(0);
+    vectorPartialSort(partial, 10);
+    for (int i = 0; i < 10; i++) EXPECT_EQ(partial[i], i + 1);
+    EXPECT_ANY_THROW(vectorPartialSort(partial, 100));
+}
+
+TEST(TVectorTest, SegmentedVectorKeepsAddresses) {
+    TSegmentedVector<std::string, std::allocator<std::string>, 64> vec;
+    std::vector<std::string> model;
+    EXPECT_ANY_THROW(vec.at(0));
+    EXPECT_ANY_THROW(vec.pop_back());
+
+    // Growth never moves an element
+    std::vector<const std::string*> addresses;
+    for (int i = 0; i < 1000; i++) {
+        addresses.push_back(&vec.emplace_back(std::to_string(i)));
+        model.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(vec.is_clean(), true);
+    EXPECT_EQ(vec.chunk_count(), 16);
+    for (size_t i = 0; i < model.size(); i++) {
+        EXPECT_EQ(&vec[i], addresses[i]);
+        EXPECT_EQ(vec[i], model[i]);
+    }
+
+    // Tombstones and compaction stay inside one chunk
+    std::mt19937 gen(3);
+    for (int i = 0; i < 300; i++) {
+        size_t index = gen() % model.size();
+        switch (gen() % 4) {
+        case 0:
+            vec.erase(index);
+            model.erase(model.begin() + static_cast<std::ptrdiff_t>(index));
+            break;
+        case 1:
+            vec.insert(index, "x" + std::to_string(i));
+            model.insert(model.begin() + static_cast<std::ptrdiff_t>(index), "x" + std::to_string(i));
+            break;
+        case 2:
+            vec.push_back("y" + std::to_string(i));
+            model.push_back("y" + std::to_string(i));
+            break;
+        default:
+            vec.pop_back();
+            model.pop_back();
+            break;
+        }
+    }
+    EXPECT_EQ(vec.is_clean(), false);
+    EXPECT_EQ(vec.size(), model.size());
+    for (size_t i = 0; i < model.size(); i++) EXPECT_EQ(vec.at(i), model[i]);
+    EXPECT_EQ(std::equal(vec.begin(), vec.end(), model.begin(), model.end()), true);
+    vec.push_front("front");
+    model.insert(model.begin(), "front");
+    vec.pop_front();
+    model.erase(model.begin());
+
+    TSegmentedVector<std::string, std::allocator<std::string>, 64> copy(vec);
+    EXPECT_EQ(copy.is_clean(), true);
+    EXPECT_EQ(std::equal(copy.begin(), copy.end(), model.begin(), model.end()), true);
+    vec.shrink_to_fit();
+    EXPECT_EQ(vec.is_clean(), true);
+    EXPECT_EQ(vec.capacity(), vec.chunk_count() * 64);
+    for (size_t i = 0; i < model.size(); i++) EXPECT_EQ(vec[i], model[i]);
+
+    const std::string* last = &vec.back();
+    vec.reserve(vec.size() + 500);
+    for (int i = 0; i < 500; i++) vec.push_back("z");
+    EXPECT_EQ(&vec[model.size() - 1], last);
+    vec.clear();
+    EXPECT_EQ(vec.is_empty(), true);
+    EXPECT_EQ(vec.begin() == vec.end(), true);
+}
+
+#if defined(__cpp_lib_constexpr_dynamic_alloc)
+constexpr int static_vector_sum() {
+    TStaticVector<int, 8> vec({ 3, 1, 4 });
+    vec.push_front(7);
+    vec.insert(2, 5);
+    vec.erase(1);
+    vec.pop_back();
+    int sum = 0;
+    for (int value : vec) sum += value;
+    return sum * 10 + find_last(vec, 5);
+}
+static_assert(static_vector_sum() == 131, "TStaticVector must be usable in constant expressions");
+#endif
+
+TEST(TVectorTest, StaticVectorMatchesTVector) {
+    static_assert(sizeof(TStaticVector<uint8_t, 15>) == 16, "a small capacity gets a one-byte count");
+    static_assert(std::is_trivially_destructible<TStaticVector<int, 4>>::value, "trivial elements need no destructor");
+
+    TStaticVector<std::string, 6> vec;
+    TVector<std::string> model;
+    EXPECT_EQ(vec.is_empty(), true);
+    EXPECT_ANY_THROW(vec.at(0));
+    EXPECT_ANY_THROW(vec.pop_back());
+    EXPECT_ANY_THROW(find_first(vec, std::string("a")));
+    for (const char* value : { "b", "c", "d" }) {
+        vec.push_back(value);
+        model.push_back(value);
+    }
+    vec.push_front("a");
+    model.push_front("a");
+    vec.insert(2, "x");
+    model.insert(2, "x");
+    vec.emplace_back("x");
+    model.emplace_back("x");
+    EXPECT_EQ(vec.is_full(), true);
+    EXPECT_THROW(vec.push_back("y"), std::length_error);
+    EXPECT_THROW(vec.insert(0, "y"), std::length_error);
+    EXPECT_EQ(vec.size(), model.size());
+    for (size_t i = 0; i < vec.size(); i++) EXPECT_EQ(vec.at(i), model.at(i));
+
+    EXPECT_EQ(find_first(vec, std::string("x")), find_first(model, std::string("x")));
+    EXPECT_EQ(find_last(vec, std::string("x")), find_last(model, std::string("x")));
+    EXPECT_EQ(find_all(vec, std::string("x")) == find_all(model, std::string("x")), true);
+    EXPECT_EQ(find_first(vec, std::string("z")), -1);
+
+    vec.erase(1);
+    model.erase(1);
+    vec.pop_front();
+    model.pop_front();
+    EXPECT_ANY_THROW(vec.erase(4));
+    EXPECT_EQ(std::equal(vec.begin(), vec.end(), model.begin(), model.end()), true);
+    EXPECT_EQ(vec.erase_if([](const std::string& value) { return value == "x"; }), 2);
+    EXPECT_EQ(vec.size(), 2);
+    EXPECT_EQ(vec[0], "c");
+
+    TStaticVector<std::string, 6> copy(vec);
+    EXPECT_EQ(copy == vec, true);
+    copy.resize(5);
+    EXPECT_EQ(copy.back(), "");
+    vec = copy;
+    EXPECT_EQ(vec.size(), 5);
+    vec = TStaticVector<std::string, 6>({ "q" });
+    EXPECT_EQ(vec.size(), 1);
+    EXPECT_EQ(vec != copy, true);
+    EXPECT_ANY_THROW(vec.resize(7));
+    vec.clear();
+    EXPECT_EQ(vec.begin() == vec.end(), true);
+}
+
+TEST(TVectorTest, AlignedAllocatorGrowsMappedBuffers) {
+    TAlignedVector<float> small;
+    for (int i = 0; i < 1000; i++) {
+        small.push_back(static_cast<float>(i));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(&*small.begin()) % 64, 0);
+    }
+
+    // A 64 KiB threshold puts the vector on the mapped path, growth goes through reallocate()
+    using allocator = TVectorAlignedAllocator<int, 64, (1 << 16)>;
+    static_assert(TVectorReallocatable<allocator>::value, "the mapped path must be picked up by TVector");
+    TVector<int, TGeometricGrowth<>, allocator> vec;
+    std::vector<int> model;
+    for (int i = 0; i < 200000; i++) {
+        vec.push_back(i);
+        model.push_back(i);
+        if (i % 1000 == 999) {
+            vec.erase(vec.size() - 500);
+            model.erase(model.end() - 500);
+        }
+    }
+    for (int i = 0; i < 5000; i++) {
+        vec.push_front(-i);
+        model.insert(model.begin(), -i);
+    }
+    EXPECT_EQ(vec.size(), model.size());
+    EXPECT_EQ(std::equal(vec.begin(), vec.end(), model.begin(), model.end()), true);
+    EXPECT_EQ(allocator::is_mapped(vec.capacity()), true);
+
+    TVector<int, TGeometricGrowth<>, allocator> copy(vec);
+    EXPECT_EQ(copy == vec, true);
+    vec.shrink_to_fit();
+    EXPECT_EQ(std::equal(vec.begin(), vec.end(), model.begin(), model.end()), true);
+}
+
+TEST(TVectorTest, VectorSurvivesThrowingCopies) {
+    TVector<FragileCopy> vec;
+    std::vector<int> model;
+    for (int i = 0; i < 20; i++) {
+        vec.push_back(FragileCopy(i));
+        model.push_back(i);
+    }
+    auto matches = [&]() {
+        if (vec.size() != model.size()) return false;
+        for (size_t i = 0; i < model.size(); i++) {
+            if (vec.at(i).value != model[i]) return false;
+        }
+        size_t index = 0;
+        for (const FragileCopy& element : vec) {
+            if (element.value != model[index++]) return false;
+        }
+        return index == model.size();
+    };
+
+    // Compaction fails midway: the moved elements stay, the tombstones too
+    for (int i = 0; i < 2; i++) {
+        vec.erase(4);
+        model.erase(model.begin() + 4);
+    }
+    FragileCopy::budget = 2;
+    EXPECT_THROW(vec.compact(), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(matches(), true);
+    vec.compact();
+    EXPECT_EQ(matches(), true);
+
+    // Shifting for a middle insert fails: the shifted elements go back
+    FragileCopy::budget = 3;
+    EXPECT_THROW(vec.insert(2, FragileCopy(-1)), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(matches(), true);
+
+    // The same over tombstones
+    vec.erase(8);
+    model.erase(model.begin() + 8);
+    FragileCopy::budget = 5;
+    EXPECT_THROW(vec.insert(3, FragileCopy(-2)), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(matches(), true);
+
+    vec.insert(3, FragileCopy(-2));
+    model.insert(model.begin() + 3, -2);
+    EXPECT_EQ(matches(), true);
+    vec.compact();
+    EXPECT_EQ(matches(), true);
+}
+
+TEST(TVectorTest, SegmentedVectorSurvivesThrowingCopies) {
+    TSegmentedVector<FragileCopy, std::allocator<FragileCopy>, 64> vec;
+    std::vector<int> model;
+    for (int i = 0; i < 65; i++) {
+        vec.push_back(FragileCopy(i));
+        model.push_back(i);
+    }
+    auto matches = [&]() {
+        if (vec.size() != model.size()) return false;
+        for (size_t i = 0; i < model.size(); i++) {
+            if (vec.at(i).value != model[i]) return false;
+        }
+        size_t index = 0;
+        for (const FragileCopy& element : vec) {
+            if (element.value != model[index++]) return false;
+        }
+        return true;
+    };
+
+    // Splitting the full first chunk fails: nothing changes
+    FragileCopy::budget = 1;
+    EXPECT_THROW(vec.insert(10, FragileCopy(-1)), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(vec.chunk_count(), 2);
+    EXPECT_EQ(matches(), true);
+
+    // Compaction fails midway: the erase is done, the chunk stays consistent
+    for (int i = 0; i < 8; i++) {
+        vec.erase(0);
+        model.erase(model.begin());
+    }
+    FragileCopy::budget = 3;
+    EXPECT_THROW(vec.erase(0), std::runtime_error);
+    FragileCopy::budget = -1;
+    model.erase(model.begin());
+    EXPECT_EQ(matches(), true);
+
+    vec.insert(10, FragileCopy(-1));
+    model.insert(model.begin() + 10, -1);
+    EXPECT_EQ(matches(), true);
+
+    // Shifting inside the chunk fails: the shifted elements go back
+    FragileCopy::budget = 4;
+    EXPECT_THROW(vec.insert(12, FragileCopy(-2)), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(matches(), true);
+    FragileCopy::budget = 1;
+    EXPECT_THROW(vec.insert(3, FragileCopy(-3)), std::runtime_error);
+    FragileCopy::budget = -1;
+    EXPECT_EQ(matches(), true);
+}